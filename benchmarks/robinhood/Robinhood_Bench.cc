@@ -0,0 +1,287 @@
+#include <FixedSizeRobinhoodSet.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Benchmark suite of robinhood_set_fixed against std::unordered_set:
+// insert, successful find, unsuccessful find and erase, for uint32_t,
+// uint64_t and string keys, tables sized from L1 resident to DRAM, at load
+// factors from 0.5 to 0.99. Prints one record per (container, key, table,
+// load factor, op) as CSV (default) or JSON, to track regressions.
+//
+// Usage: robinhood_bench [--format=csv|json] [--max-table-bytes=N]
+//
+// Every op runs twice: once untimed per op for the throughput, once with 1
+// op out of kLatencySampling timed on its own for the latency percentiles,
+// which include the clock overhead (about 20ns).
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kLatencySampling = 8;
+// Small tables are rebuilt and measured again until every op ran this many
+// times
+constexpr size_t kMinOpsPerRecord = size_t{1} << 20;
+constexpr double kLoadFactors[] = {0.5, 0.7, 0.8, 0.9, 0.95, 0.99};
+// Bucket array sizes: L1, L2, LLC and DRAM resident
+constexpr size_t kTableBytes[] = {size_t{16} << 10,
+                                  size_t{512} << 10,
+                                  size_t{8} << 20,
+                                  size_t{256} << 20};
+
+// Keeps lookups from being optimized away
+static volatile size_t gSink;
+
+struct Percentiles {
+  double p50, p90, p99, p999;
+};
+
+struct Record {
+  std::string_view container;
+  std::string_view key;
+  size_t tableBytes;
+  size_t capacity;
+  double loadFactor;
+  std::string_view op;
+  size_t numOps;
+  double totalNs;
+  Percentiles latency;
+};
+
+enum class Format { Csv, Json };
+
+class Reporter {
+  Format format;
+  bool first{true};
+
+ public:
+  explicit Reporter(Format f) : format(f) {
+    if (format == Format::Csv)
+      std::cout << "container,key,table_bytes,capacity,load_factor,op,"
+                   "num_ops,mops_per_sec,ns_per_op,p50_ns,p90_ns,p99_ns,"
+                   "p999_ns\n";
+    else
+      std::cout << "[";
+  }
+  ~Reporter() {
+    if (format == Format::Json)
+      std::cout << "\n]\n";
+  }
+
+  void report(const Record& r) {
+    double nsPerOp = r.totalNs / r.numOps;
+    if (format == Format::Csv) {
+      std::cout << r.container << "," << r.key << "," << r.tableBytes << ","
+                << r.capacity << "," << r.loadFactor << "," << r.op << ","
+                << r.numOps << "," << 1e3 / nsPerOp << "," << nsPerOp << ","
+                << r.latency.p50 << "," << r.latency.p90 << ","
+                << r.latency.p99 << "," << r.latency.p999 << "\n";
+    } else {
+      std::cout << (first ? "\n" : ",\n") << "  {\"container\": \""
+                << r.container << "\", \"key\": \"" << r.key
+                << "\", \"table_bytes\": " << r.tableBytes
+                << ", \"capacity\": " << r.capacity
+                << ", \"load_factor\": " << r.loadFactor << ", \"op\": \""
+                << r.op << "\", \"num_ops\": " << r.numOps
+                << ", \"mops_per_sec\": " << 1e3 / nsPerOp
+                << ", \"ns_per_op\": " << nsPerOp
+                << ", \"p50_ns\": " << r.latency.p50
+                << ", \"p90_ns\": " << r.latency.p90
+                << ", \"p99_ns\": " << r.latency.p99
+                << ", \"p999_ns\": " << r.latency.p999 << "}";
+    }
+    std::cout.flush();
+    first = false;
+  }
+};
+
+// Distinct keys: i * odd constant is a bijection over the key width
+template <class KeyT>
+KeyT makeKey(uint64_t i) {
+  if constexpr (std::is_same_v<KeyT, std::string>) {
+    // 16 chars, past the small string optimization of libstdc++
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx",
+                  static_cast<unsigned long long>(i * 0x9e3779b97f4a7c15ull));
+    return std::string(buf, 16);
+  } else {
+    return static_cast<KeyT>(i * 0x9e3779b97f4a7c15ull);
+  }
+}
+
+// Same interface over both containers
+template <class KeyT>
+struct RobinhoodAdapter {
+  static constexpr std::string_view name = "robinhood_set_fixed";
+  ykoh::robinhood::robinhood_set_fixed<KeyT> set;
+  explicit RobinhoodAdapter(size_t capacity, size_t) : set(capacity) {}
+  bool insert(const KeyT& k) { return set.insert(k); }
+  bool contains(const KeyT& k) { return set.find(k) != set.end(); }
+  bool erase(const KeyT& k) { return set.erase(k); }
+};
+template <class KeyT>
+struct UnorderedSetAdapter {
+  static constexpr std::string_view name = "std::unordered_set";
+  std::unordered_set<KeyT> set;
+  explicit UnorderedSetAdapter(size_t, size_t numKeys) {
+    set.reserve(numKeys);
+  }
+  bool insert(const KeyT& k) { return set.insert(k).second; }
+  bool contains(const KeyT& k) { return set.count(k) == 1; }
+  bool erase(const KeyT& k) { return set.erase(k) == 1; }
+};
+
+Percentiles percentilesOf(std::vector<uint32_t>& samples) {
+  if (samples.empty())
+    return {};
+  auto at = [&samples](double q) {
+    auto nth = samples.begin() + static_cast<size_t>(q * (samples.size() - 1));
+    std::nth_element(samples.begin(), nth, samples.end());
+    return static_cast<double>(*nth);
+  };
+  return {at(0.5), at(0.9), at(0.99), at(0.999)};
+}
+
+// Runs op on every key, returns the total time in ns
+template <class Op, class KeyT>
+double timeOps(const Op& op, const std::vector<KeyT>& keys) {
+  size_t hits = 0;
+  auto start = Clock::now();
+  for (const auto& k : keys)
+    hits += op(k);
+  auto ns = std::chrono::duration<double, std::nano>(Clock::now() - start);
+  gSink = hits;
+  return ns.count();
+}
+
+// Runs op on every key, timing 1 op out of kLatencySampling on its own
+template <class Op, class KeyT>
+void sampleLatencies(const Op& op,
+                     const std::vector<KeyT>& keys,
+                     std::vector<uint32_t>& samples) {
+  size_t hits = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (i % kLatencySampling != 0) {
+      hits += op(keys[i]);
+      continue;
+    }
+    auto start = Clock::now();
+    hits += op(keys[i]);
+    auto ns = std::chrono::duration<double, std::nano>(Clock::now() - start);
+    samples.push_back(static_cast<uint32_t>(ns.count()));
+  }
+  gSink = hits;
+}
+
+template <class Adapter, class KeyT>
+void benchContainer(Reporter& reporter,
+                    std::string_view keyName,
+                    size_t tableBytes,
+                    size_t capacity,
+                    double loadFactor,
+                    const std::vector<KeyT>& keys,
+                    const std::vector<KeyT>& shuffledKeys,
+                    const std::vector<KeyT>& misses) {
+  auto insert = [](Adapter& a) {
+    return [&a](const KeyT& k) { return a.insert(k); };
+  };
+  auto contains = [](Adapter& a) {
+    return [&a](const KeyT& k) { return a.contains(k); };
+  };
+  auto erase = [](Adapter& a) {
+    return [&a](const KeyT& k) { return a.erase(k); };
+  };
+  const size_t numRounds =
+      std::max<size_t>(kMinOpsPerRecord / std::max<size_t>(keys.size(), 1), 1);
+
+  double insertNs = 0, hitNs = 0, missNs = 0, eraseNs = 0;
+  for (size_t round = 0; round < numRounds; ++round) {
+    Adapter a(capacity, keys.size());
+    insertNs += timeOps(insert(a), keys);
+    hitNs += timeOps(contains(a), shuffledKeys);
+    missNs += timeOps(contains(a), misses);
+    eraseNs += timeOps(erase(a), shuffledKeys);
+  }
+  std::vector<uint32_t> insertLat, hitLat, missLat, eraseLat;
+  for (size_t round = 0; round < numRounds; ++round) {
+    Adapter a(capacity, keys.size());
+    sampleLatencies(insert(a), keys, insertLat);
+    sampleLatencies(contains(a), shuffledKeys, hitLat);
+    sampleLatencies(contains(a), misses, missLat);
+    sampleLatencies(erase(a), shuffledKeys, eraseLat);
+  }
+
+  auto report = [&](std::string_view op, double ns,
+                    std::vector<uint32_t>& samples) {
+    reporter.report(Record{Adapter::name, keyName, tableBytes, capacity,
+                           loadFactor, op, keys.size() * numRounds, ns,
+                           percentilesOf(samples)});
+  };
+  report("insert", insertNs, insertLat);
+  report("find_hit", hitNs, hitLat);
+  report("find_miss", missNs, missLat);
+  report("erase", eraseNs, eraseLat);
+}
+
+template <class KeyT>
+void benchKeyType(Reporter& reporter,
+                  std::string_view keyName,
+                  size_t maxTableBytes) {
+  using EntryT = typename ykoh::robinhood::robinhood_set_fixed<KeyT>::EntryT;
+  for (auto tableBytes : kTableBytes) {
+    if (tableBytes > maxTableBytes)
+      break;
+    const size_t capacity = tableBytes / sizeof(EntryT);
+    for (auto loadFactor : kLoadFactors) {
+      const auto numKeys = static_cast<size_t>(capacity * loadFactor);
+      std::vector<KeyT> keys(numKeys), misses(numKeys);
+      for (size_t i = 0; i < numKeys; ++i) {
+        keys[i] = makeKey<KeyT>(i);
+        misses[i] = makeKey<KeyT>(numKeys + i);
+      }
+      auto shuffledKeys = keys;
+      std::shuffle(shuffledKeys.begin(), shuffledKeys.end(),
+                   std::mt19937_64(42));
+
+      benchContainer<RobinhoodAdapter<KeyT>>(reporter, keyName, tableBytes,
+                                             capacity, loadFactor, keys,
+                                             shuffledKeys, misses);
+      benchContainer<UnorderedSetAdapter<KeyT>>(reporter, keyName,
+                                                tableBytes, capacity,
+                                                loadFactor, keys,
+                                                shuffledKeys, misses);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  auto format = Format::Csv;
+  size_t maxTableBytes = kTableBytes[std::size(kTableBytes) - 1];
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg == "--format=csv") {
+      format = Format::Csv;
+    } else if (arg == "--format=json") {
+      format = Format::Json;
+    } else if (arg.starts_with("--max-table-bytes=")) {
+      maxTableBytes = std::strtoull(argv[i] + 18, nullptr, 10);
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--format=csv|json] [--max-table-bytes=N]\n";
+      return 1;
+    }
+  }
+
+  Reporter reporter(format);
+  benchKeyType<uint32_t>(reporter, "u32", maxTableBytes);
+  benchKeyType<uint64_t>(reporter, "u64", maxTableBytes);
+  benchKeyType<std::string>(reporter, "string", maxTableBytes);
+  return 0;
+}
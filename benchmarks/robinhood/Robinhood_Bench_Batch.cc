@@ -0,0 +1,62 @@
+#include <CapacityPolicy.hpp>
+#include <FixedSizeRobinhoodSet.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <span>
+#include <vector>
+
+// Compares single-key lookups against contains_batch, which prefetches the
+// home buckets of a block of keys before resolving any of them.
+
+using Clock = std::chrono::steady_clock;
+
+void benchBatch(size_t capacity, size_t batchSize) {
+  using SetT = ykoh::robinhood::
+      robinhood_set_fixed<uint64_t, 0, KeyTraits<uint64_t>, PowerOfTwoCapacity>;
+  SetT s(capacity);
+  const size_t numKeys = s.capacity() * 8 / 10;
+
+  std::mt19937_64 gen(42);
+  std::vector<uint64_t> keys(numKeys);
+  for (auto& k : keys)
+    k = gen();
+  for (auto k : keys)
+    s.insert(k);
+  // Lookups in random order, half of them misses
+  std::vector<uint64_t> queries(numKeys);
+  for (auto& q : queries)
+    q = (gen() & 1) ? keys[gen() % numKeys] : gen();
+
+  size_t found = 0;
+  auto start = Clock::now();
+  for (auto q : queries)
+    found += s.find(q) != s.end();
+  auto singleNs =
+      std::chrono::duration<double, std::nano>(Clock::now() - start);
+
+  size_t foundBatch = 0;
+  std::vector<uint64_t> bitmap((batchSize + 63) / 64);
+  start = Clock::now();
+  for (size_t base = 0; base < queries.size(); base += batchSize) {
+    auto len = std::min(batchSize, queries.size() - base);
+    foundBatch += s.contains_batch(
+        std::span<const uint64_t>(queries.data() + base, len), bitmap);
+  }
+  auto batchNs = std::chrono::duration<double, std::nano>(Clock::now() - start);
+
+  std::cout << "capacity=" << s.capacity() << ",batch=" << batchSize
+            << ",single_ns=" << singleNs.count() / numKeys
+            << ",batch_ns=" << batchNs.count() / numKeys
+            << ",speedup=" << singleNs.count() / batchNs.count()
+            << ",found=" << found << "/" << foundBatch << "\n";
+}
+
+int main() {
+  benchBatch(1 << 14, 256);
+  benchBatch(1 << 23, 256);
+  benchBatch(1 << 23, 4096);
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include <CapacityPolicy.hpp>
+#include <FixedSizeRobinhoodSet.hpp>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+// Compares the cost of mapping hashes to home positions for every
+// CapacityPolicy: modulo (integer division), power of two (mask) and
+// fastrange (multiply-shift), at the same load factor.
+
+using Clock = std::chrono::steady_clock;
+
+template <class Policy>
+void benchPolicy(std::string_view name, size_t requestedCapacity) {
+  using SetT = ykoh::robinhood::
+      robinhood_set_fixed<uint64_t, 0, KeyTraits<uint64_t>, Policy>;
+  SetT s(requestedCapacity);
+  const size_t numKeys = s.capacity() * 8 / 10;
+
+  std::mt19937_64 gen(42);
+  std::vector<uint64_t> keys(numKeys);
+  for (auto& k : keys)
+    k = gen();
+  std::vector<uint64_t> misses(numKeys);
+  for (auto& k : misses)
+    k = gen();
+
+  auto start = Clock::now();
+  for (auto k : keys)
+    s.insert(k);
+  auto insertNs =
+      std::chrono::duration<double, std::nano>(Clock::now() - start);
+
+  size_t found = 0;
+  start = Clock::now();
+  for (auto k : keys)
+    found += s.find(k) != s.end();
+  auto hitNs = std::chrono::duration<double, std::nano>(Clock::now() - start);
+
+  start = Clock::now();
+  for (auto k : misses)
+    found += s.find(k) != s.end();
+  auto missNs = std::chrono::duration<double, std::nano>(Clock::now() - start);
+
+  std::cout << name << ",capacity=" << s.capacity() << ",keys=" << numKeys
+            << ",insert_ns=" << insertNs.count() / numKeys
+            << ",find_hit_ns=" << hitNs.count() / numKeys
+            << ",find_miss_ns=" << missNs.count() / numKeys
+            << ",found=" << found << "\n";
+}
+
+int main() {
+  // Small enough to stay cache resident, so the reduction dominates
+  constexpr size_t smallCap = 1 << 14;
+  benchPolicy<ModuloCapacity>("modulo", smallCap);
+  benchPolicy<PowerOfTwoCapacity>("pow2", smallCap);
+  benchPolicy<FastRangeCapacity>("fastrange", smallCap);
+  // Larger than LLC
+  constexpr size_t largeCap = 1 << 23;
+  benchPolicy<ModuloCapacity>("modulo", largeCap);
+  benchPolicy<PowerOfTwoCapacity>("pow2", largeCap);
+  benchPolicy<FastRangeCapacity>("fastrange", largeCap);
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include <ConcurrentRobinhoodSet.hpp>
+#include <FixedSizeRobinhoodSet.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Throughput of a read-mostly workload (90% contains, 5% insert, 5% erase)
+// over 1 to N threads, for the sharded concurrent set and for a single
+// robinhood_set_fixed behind one global mutex.
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kCapacity = 1 << 22;
+constexpr size_t kOpsPerThread = 2000000;
+
+struct GlobalMutexSet {
+  std::mutex m;
+  ykoh::robinhood::robinhood_set_fixed<uint64_t> set{kCapacity};
+  bool insert(uint64_t k) {
+    std::lock_guard<std::mutex> lock(m);
+    return set.insert(k);
+  }
+  bool erase(uint64_t k) {
+    std::lock_guard<std::mutex> lock(m);
+    return set.erase(k);
+  }
+  bool contains(uint64_t k) {
+    std::lock_guard<std::mutex> lock(m);
+    return set.find(k) != set.end();
+  }
+};
+
+template <class SetT>
+void benchThreads(std::string_view name, SetT& s, size_t numThreads) {
+  // Half full before starting
+  for (uint64_t k = 0; k < kCapacity / 2; ++k)
+    s.insert(k);
+
+  std::atomic<size_t> hits{0};
+  std::vector<std::thread> threads;
+  auto start = Clock::now();
+  for (size_t t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937_64 gen(t);
+      size_t localHits = 0;
+      for (size_t i = 0; i < kOpsPerThread; ++i) {
+        auto k = gen() % kCapacity;
+        auto op = gen() % 100;
+        if (op < 90)
+          localHits += s.contains(k);
+        else if (op < 95)
+          s.insert(k);
+        else
+          s.erase(k);
+      }
+      hits += localHits;
+    });
+  }
+  for (auto& t : threads)
+    t.join();
+  auto secs = std::chrono::duration<double>(Clock::now() - start).count();
+  std::cout << name << ",threads=" << numThreads << ",mops_per_sec="
+            << numThreads * kOpsPerThread / secs / 1e6
+            << ",hits=" << hits.load() << "\n";
+}
+
+int main() {
+  auto maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+    ykoh::robinhood::concurrent_robinhood_set<uint64_t> sharded(kCapacity);
+    benchThreads("sharded", sharded, threads);
+    GlobalMutexSet global;
+    benchThreads("global_mutex", global, threads);
+  }
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include <FixedSizeRobinhoodSet.hpp>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Compares memory per key and lookup latency of every bucket layout:
+// array of entries (AoS), one array per field (SoA) and keys only with the
+// PSL recomputed from the hash (KeyOnly), at the same load factor.
+
+using Clock = std::chrono::steady_clock;
+
+template <class KeyT>
+KeyT makeKey(uint64_t v) {
+  if constexpr (std::is_same_v<KeyT, std::string>)
+    return "some/longer/key/" + std::to_string(v);
+  else
+    return static_cast<KeyT>(v);
+}
+
+template <class KeyT, class Layout>
+void benchLayout(std::string_view name, size_t requestedCapacity) {
+  using SetT = ykoh::robinhood::robinhood_set_fixed<KeyT,
+                                                    0,
+                                                    KeyTraits<KeyT>,
+                                                    ModuloCapacity,
+                                                    NoStats,
+                                                    Layout>;
+  SetT s(requestedCapacity);
+  const size_t numKeys = s.capacity() * 8 / 10;
+
+  std::mt19937_64 gen(42);
+  std::vector<KeyT> keys(numKeys);
+  for (auto& k : keys)
+    k = makeKey<KeyT>(gen());
+  std::vector<KeyT> misses(numKeys);
+  for (auto& k : misses)
+    k = makeKey<KeyT>(gen());
+  for (const auto& k : keys)
+    s.insert(k);
+
+  size_t found = 0;
+  auto start = Clock::now();
+  for (const auto& k : keys)
+    found += s.find(k) != s.end();
+  auto hitNs = std::chrono::duration<double, std::nano>(Clock::now() - start);
+
+  start = Clock::now();
+  for (const auto& k : misses)
+    found += s.find(k) != s.end();
+  auto missNs = std::chrono::duration<double, std::nano>(Clock::now() - start);
+
+  std::cout << name << ",capacity=" << s.capacity() << ",keys=" << numKeys
+            << ",bytes_per_key="
+            << static_cast<double>(s.memory_usage()) / numKeys
+            << ",find_hit_ns=" << hitNs.count() / numKeys
+            << ",find_miss_ns=" << missNs.count() / numKeys
+            << ",found=" << found << "\n";
+}
+
+template <class KeyT>
+void benchAllLayouts(std::string_view keyName, size_t requestedCapacity) {
+  using namespace ykoh::robinhood;
+  benchLayout<KeyT, AoSLayout>(std::string(keyName) + "/aos",
+                               requestedCapacity);
+  benchLayout<KeyT, SoALayout>(std::string(keyName) + "/soa",
+                               requestedCapacity);
+  benchLayout<KeyT, KeyOnlyLayout>(std::string(keyName) + "/keyonly",
+                                   requestedCapacity);
+}
+
+int main() {
+  // Cache resident, then larger than LLC
+  for (size_t cap : {size_t{1} << 14, size_t{1} << 23}) {
+    benchAllLayouts<uint32_t>("u32", cap);
+    benchAllLayouts<uint64_t>("u64", cap);
+  }
+  // Expensive keys, where recomputing the PSL costs a string hash
+  benchAllLayouts<std::string>("string", size_t{1} << 18);
+  return 0;
+}
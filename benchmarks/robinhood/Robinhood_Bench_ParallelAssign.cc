@@ -0,0 +1,58 @@
+#include <FixedSizeRobinhoodSet.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Bulk build time of assign_parallel over 1 to N threads at 90% load,
+// compared to assign and to inserting keys one by one. Once the tables are
+// larger than the LLC, scaling is bounded by memory bandwidth.
+
+using Clock = std::chrono::steady_clock;
+using SetT = ykoh::robinhood::robinhood_set_fixed<uint64_t>;
+
+template <class Build>
+double timeBuildNs(const Build& build) {
+  auto start = Clock::now();
+  build();
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+      .count();
+}
+
+void benchCapacity(size_t capacity) {
+  const size_t numKeys = capacity * 9 / 10;
+  std::mt19937_64 gen(42);
+  std::vector<uint64_t> keys(numKeys);
+  for (auto& k : keys)
+    k = gen();
+
+  SetT s(capacity);
+  auto insertNs = timeBuildNs([&] {
+    for (auto k : keys)
+      s.insert(k);
+  });
+  std::cout << "insert,capacity=" << capacity << ",threads=1,ns_per_key="
+            << insertNs / numKeys << "\n";
+  auto assignNs = timeBuildNs([&] { s.assign(keys.begin(), keys.end()); });
+  std::cout << "assign,capacity=" << capacity << ",threads=1,ns_per_key="
+            << assignNs / numKeys << "\n";
+
+  auto maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+    auto ns = timeBuildNs(
+        [&] { s.assign_parallel(keys.begin(), keys.end(), threads); });
+    std::cout << "assign_parallel,capacity=" << capacity
+              << ",threads=" << threads << ",ns_per_key=" << ns / numKeys
+              << ",speedup=" << assignNs / ns << "\n";
+  }
+}
+
+int main() {
+  // Cache resident, then larger than LLC
+  benchCapacity(1 << 16);
+  benchCapacity(1 << 24);
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <SparseTable.hpp>
+#include <SparseTableOps.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Sparse table build time from n = 10^6 up to --max-n (default 10^7, the
+// levels of 10^8 values take over 10GB): the scalar loop of a plain lambda
+// against the SIMD build of the ops tags, on 1 to N threads.
+//
+// Usage: sparse_table_bench_Build [--max-n=N]
+
+using Clock = std::chrono::steady_clock;
+
+template <class Func, typename T>
+double buildMs(const std::vector<T> &data, size_t numThreads) {
+  auto start = Clock::now();
+  ykoh::sparse_tb::SparseTable<T, Func> table(data, numThreads);
+  auto ms = std::chrono::duration<double, std::milli>(Clock::now() - start);
+  // Keep the table alive until timed
+  volatile auto sink = table.computeOverlappingForRange(0, data.size(), T{});
+  (void)sink;
+  return ms.count();
+}
+
+template <typename T, class ScalarFunc, class TagFunc>
+void benchOp(std::string_view name, size_t n) {
+  std::mt19937_64 gen(42);
+  std::vector<T> data(n);
+  for (auto &x : data)
+    x = static_cast<T>(gen());
+
+  auto scalarMs = buildMs<ScalarFunc>(data, 1);
+  std::cout << name << ",n=" << n << ",build=scalar,threads=1,ms=" << scalarMs
+            << "\n";
+  auto maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+    auto ms = buildMs<TagFunc>(data, threads);
+    std::cout << name << ",n=" << n << ",build=simd,threads=" << threads
+              << ",ms=" << ms << ",speedup=" << scalarMs / ms << "\n";
+  }
+}
+
+int main(int argc, char **argv) {
+  size_t maxN = 10000000;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg.starts_with("--max-n=")) {
+      maxN = std::strtoull(argv[i] + 8, nullptr, 10);
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--max-n=N]\n";
+      return 1;
+    }
+  }
+
+  auto minLambda = [](auto x, auto y) { return std::min(x, y); };
+  auto sumLambda = [](auto x, auto y) { return x + y; };
+  for (size_t n = 1000000; n <= maxN; n *= 10) {
+    benchOp<int32_t, decltype(minLambda), ykoh::sparse_tb::ops::Min>("min_i32",
+                                                                     n);
+    benchOp<int64_t, decltype(sumLambda), ykoh::sparse_tb::ops::Sum>("sum_i64",
+                                                                     n);
+  }
+  return 0;
+}
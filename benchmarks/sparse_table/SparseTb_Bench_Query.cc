@@ -0,0 +1,145 @@
+#include <DisjointSparseTable.hpp>
+#include <SparseTable.hpp>
+#include <SparseTableBlocked.hpp>
+#include <SparseTableOps.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Random range query throughput on a table of n = 10^7 values: one
+// computeOverlappingForRange / computeForRange call per query against the
+// batched computeOverlappingForRanges / computeForRanges, and the memory
+// and single query time of SparseTableBlocked against the full table and of
+// DisjointSparseTable against computeForRange.
+//
+// Usage: sparse_table_bench_Query [--queries=N]
+
+using Clock = std::chrono::steady_clock;
+using RangeT = std::pair<size_t, size_t>;
+
+template <typename Fn> double elapsedMs(Fn &&fn) {
+  auto start = Clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+template <typename T, class Func>
+void benchOp(std::string_view name, size_t n, size_t numQueries) {
+  std::mt19937_64 gen(42);
+  std::vector<T> data(n);
+  for (auto &x : data)
+    x = static_cast<T>(gen());
+  ykoh::sparse_tb::SparseTable<T, Func> table(data);
+
+  std::vector<RangeT> ranges(numQueries);
+  for (auto &range : ranges)
+    range = std::minmax(gen() % (n + 1), gen() % (n + 1));
+  std::vector<T> out(numQueries);
+
+  auto report = [&](std::string_view query, std::string_view api, double ms) {
+    std::cout << name << ",n=" << n << ",query=" << query << ",api=" << api
+              << ",ms=" << ms << ",mqps=" << numQueries / ms / 1000 << "\n";
+  };
+
+  report("overlapping", "single", elapsedMs([&] {
+           for (size_t q = 0; q < numQueries; ++q)
+             out[q] = table.computeOverlappingForRange(ranges[q].first,
+                                                       ranges[q].second, T{});
+         }));
+  report("overlapping", "batch", elapsedMs([&] {
+           table.computeOverlappingForRanges(ranges, out, T{});
+         }));
+  report("disjoint", "single", elapsedMs([&] {
+           for (size_t q = 0; q < numQueries; ++q)
+             out[q] = table.computeForRange(ranges[q].first, ranges[q].second,
+                                            T{});
+         }));
+  report("disjoint", "batch",
+         elapsedMs([&] { table.computeForRanges(ranges, out, T{}); }));
+
+  // Keep the answers alive until timed
+  volatile auto sink = out.back();
+  (void)sink;
+}
+
+template <typename T, class Func>
+void benchBlocked(std::string_view name, size_t n, size_t numQueries) {
+  std::mt19937_64 gen(42);
+  std::vector<T> data(n);
+  for (auto &x : data)
+    x = static_cast<T>(gen());
+  std::vector<RangeT> ranges(numQueries);
+  for (auto &range : ranges)
+    range = std::minmax(gen() % (n + 1), gen() % (n + 1));
+  std::vector<T> out(numQueries);
+
+  auto run = [&](std::string_view table, const auto &tb) {
+    auto ms = elapsedMs([&] {
+      for (size_t q = 0; q < numQueries; ++q)
+        out[q] = tb.computeOverlappingForRange(ranges[q].first,
+                                               ranges[q].second, T{});
+    });
+    std::cout << name << ",n=" << n << ",table=" << table
+              << ",mb=" << tb.memoryUsage() / 1e6 << ",ms=" << ms
+              << ",mqps=" << numQueries / ms / 1000 << "\n";
+  };
+  run("full", ykoh::sparse_tb::SparseTable<T, Func>(data));
+  run("blocked", ykoh::sparse_tb::SparseTableBlocked<T, Func>(data));
+
+  volatile auto sink = out.back();
+  (void)sink;
+}
+
+template <typename T, class Func>
+void benchDisjoint(std::string_view name, size_t n, size_t numQueries) {
+  std::mt19937_64 gen(42);
+  std::vector<T> data(n);
+  for (auto &x : data)
+    x = static_cast<T>(gen());
+  std::vector<RangeT> ranges(numQueries);
+  for (auto &range : ranges)
+    range = std::minmax(gen() % (n + 1), gen() % (n + 1));
+  std::vector<T> out(numQueries);
+
+  auto run = [&](std::string_view table, const auto &tb) {
+    auto ms = elapsedMs([&] {
+      for (size_t q = 0; q < numQueries; ++q)
+        out[q] = tb.computeForRange(ranges[q].first, ranges[q].second, T{});
+    });
+    std::cout << name << ",n=" << n << ",table=" << table
+              << ",mb=" << tb.memoryUsage() / 1e6 << ",ms=" << ms
+              << ",mqps=" << numQueries / ms / 1000 << "\n";
+  };
+  run("full", ykoh::sparse_tb::SparseTable<T, Func>(data));
+  run("disjoint", ykoh::sparse_tb::DisjointSparseTable<T, Func>(data));
+
+  volatile auto sink = out.back();
+  (void)sink;
+}
+
+int main(int argc, char **argv) {
+  size_t numQueries = 10000000;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg.starts_with("--queries=")) {
+      numQueries = std::strtoull(argv[i] + 10, nullptr, 10);
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--queries=N]\n";
+      return 1;
+    }
+  }
+
+  constexpr size_t n = 10000000;
+  benchOp<int32_t, ykoh::sparse_tb::ops::Min>("min_i32", n, numQueries);
+  benchOp<int64_t, ykoh::sparse_tb::ops::Sum>("sum_i64", n, numQueries);
+  benchBlocked<int32_t, ykoh::sparse_tb::ops::Min>("min_i32", n, numQueries);
+  benchDisjoint<int64_t, ykoh::sparse_tb::ops::Sum>("sum_i64", n, numQueries);
+  return 0;
+}
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace ykoh {
+namespace robinhood {
+
+// Allocators for the buckets of very large dynamically sized tables, pass
+// them as the Allocator parameter of robinhood_set_fixed.
+//
+// Memory comes straight from anonymous mmap mappings:
+//  - backed by explicit huge pages (MAP_HUGETLB) when the system has some
+//    reserved, else 2 MiB aligned and madvise(MADV_HUGEPAGE)'d so that
+//    transparent huge pages can back it, else plain 4K pages
+//  - freshly mapped pages read as zero, so buckets are not zeroed again:
+//    construct() without arguments skips trivially default constructible
+//    types instead of value initializing them
+//  - pages are not touched on allocation, each one is placed on the NUMA
+//    node of the first thread writing it (first-touch). Set prefaultThreads
+//    to instead fault every page in upfront, each thread writing an equal
+//    slice of the mapping
+//
+// HugePageAllocator maps every allocation separately, ArenaAllocator carves
+// allocations out of a HugePageArena that is mapped once.
+
+struct HugePageOptions {
+  bool useHugeTlb{true};               // try MAP_HUGETLB first
+  bool useTransparentHugePages{true};  // else madvise(MADV_HUGEPAGE)
+  unsigned prefaultThreads{0};         // 0 leaves pages to first-touch
+};
+
+namespace huge_page_detail {
+
+inline constexpr size_t kPageSize = size_t{1} << 12;
+inline constexpr size_t kHugePageSize = size_t{1} << 21;
+
+inline constexpr size_t roundUp(size_t n, size_t multiple) {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+// Length of the mapping serving a request of numBytes, only depends on
+// numBytes so that it can be recomputed when unmapping
+inline constexpr size_t mappingLength(size_t numBytes) {
+  return numBytes >= kHugePageSize / 2 ? roundUp(numBytes, kHugePageSize)
+                                       : roundUp(numBytes, kPageSize);
+}
+
+// Writes one byte per page from numThreads threads, each taking a
+// contiguous slice, so that every page is faulted in on the NUMA node of
+// the thread owning its slice
+inline void prefaultPages(void* p, size_t len, unsigned numThreads) {
+  auto bytes = static_cast<volatile char*>(p);
+  auto touch = [bytes](size_t begin, size_t end) {
+    for (size_t off = begin; off < end; off += kPageSize)
+      bytes[off] = 0;
+  };
+  auto numPages = len / kPageSize;
+  numThreads = static_cast<unsigned>(
+      std::min<size_t>(numThreads, std::max<size_t>(numPages, 1)));
+  if (numThreads <= 1)
+    return touch(0, len);
+  std::vector<std::thread> threads;
+  auto pagesPerThread = (numPages + numThreads - 1) / numThreads;
+  for (unsigned t = 0; t < numThreads; ++t) {
+    auto begin = std::min(len, t * pagesPerThread * kPageSize);
+    auto end = std::min(len, (t + 1) * pagesPerThread * kPageSize);
+    threads.emplace_back(touch, begin, end);
+  }
+  for (auto& thread : threads)
+    thread.join();
+}
+
+// Maps mappingLength(numBytes) zeroed bytes, throws std::bad_alloc on
+// failure. Also returns whether explicit huge pages back the mapping.
+inline std::pair<void*, bool> mapZeroedPages(size_t numBytes,
+                                             const HugePageOptions& options) {
+  auto len = mappingLength(numBytes);
+  constexpr int kProt = PROT_READ | PROT_WRITE;
+  constexpr int kFlags = MAP_PRIVATE | MAP_ANONYMOUS;
+  void* p = MAP_FAILED;
+  bool hugeTlb = false;
+#ifdef MAP_HUGETLB
+  if (options.useHugeTlb && len % kHugePageSize == 0) {
+    p = ::mmap(nullptr, len, kProt, kFlags | MAP_HUGETLB, -1, 0);
+    hugeTlb = p != MAP_FAILED;
+  }
+#endif
+  if (p == MAP_FAILED && len % kHugePageSize == 0) {
+    // Over map then trim, transparent huge pages need 2 MiB alignment
+    auto raw = ::mmap(nullptr, len + kHugePageSize, kProt, kFlags, -1, 0);
+    if (raw != MAP_FAILED) {
+      auto addr = reinterpret_cast<uintptr_t>(raw);
+      auto aligned = roundUp(addr, kHugePageSize);
+      if (aligned != addr)
+        ::munmap(raw, aligned - addr);
+      if (auto tail = addr + kHugePageSize - aligned; tail != 0)
+        ::munmap(reinterpret_cast<void*>(aligned + len), tail);
+      p = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+      if (options.useTransparentHugePages)
+        ::madvise(p, len, MADV_HUGEPAGE);
+#endif
+    }
+  }
+  if (p == MAP_FAILED)
+    p = ::mmap(nullptr, len, kProt, kFlags, -1, 0);
+  if (p == MAP_FAILED)
+    throw std::bad_alloc();
+  if (options.prefaultThreads > 0)
+    prefaultPages(p, len, options.prefaultThreads);
+  return {p, hugeTlb};
+}
+
+inline void unmapPages(void* p, size_t numBytes) noexcept {
+  ::munmap(p, mappingLength(numBytes));
+}
+
+// Value initialization of memory known to be zero is a no-op for trivially
+// default constructible types
+template <class U>
+inline void constructOnZeroedMemory(U* p) {
+  if constexpr (!std::is_trivially_default_constructible_v<U>)
+    ::new (static_cast<void*>(p)) U();
+}
+
+}  // namespace huge_page_detail
+
+template <class T>
+class HugePageAllocator {
+  template <class U>
+  friend class HugePageAllocator;
+
+  HugePageOptions options;
+
+ public:
+  using value_type = T;
+  // Any instance can unmap what another one mapped
+  using is_always_equal = std::true_type;
+
+  HugePageAllocator() = default;
+  explicit HugePageAllocator(HugePageOptions opts) : options(opts) {}
+  template <class U>
+  HugePageAllocator(const HugePageAllocator<U>& other) noexcept
+      : options(other.options) {}
+
+  T* allocate(size_t n) {
+    if (n > SIZE_MAX / sizeof(T))
+      throw std::bad_alloc();
+    auto mapping = huge_page_detail::mapZeroedPages(n * sizeof(T), options);
+    return static_cast<T*>(mapping.first);
+  }
+  void deallocate(T* p, size_t n) noexcept {
+    huge_page_detail::unmapPages(p, n * sizeof(T));
+  }
+
+  template <class U>
+  void construct(U* p) {
+    huge_page_detail::constructOnZeroedMemory(p);
+  }
+  template <class U, class... Args>
+  void construct(U* p, Args&&... args) {
+    ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+
+  template <class U>
+  bool operator==(const HugePageAllocator<U>&) const noexcept {
+    return true;
+  }
+};
+
+// Single huge page backed mapping handing out never reused chunks, so that
+// several tables can share huge pages. Memory is released when the arena is
+// destroyed, it must outlive the tables using it.
+class HugePageArena {
+  void* base{nullptr};
+  size_t requestedBytes{0};
+  size_t cap{0};
+  size_t used{0};
+  bool hugeTlb{false};
+
+ public:
+  explicit HugePageArena(size_t capacityBytes, HugePageOptions options = {})
+      : requestedBytes(capacityBytes),
+        cap(huge_page_detail::mappingLength(capacityBytes)) {
+    std::tie(base, hugeTlb) =
+        huge_page_detail::mapZeroedPages(capacityBytes, options);
+  }
+  ~HugePageArena() { huge_page_detail::unmapPages(base, requestedBytes); }
+  HugePageArena(const HugePageArena&) = delete;
+  HugePageArena& operator=(const HugePageArena&) = delete;
+
+  // Throws std::bad_alloc once the arena is exhausted
+  void* allocate(size_t numBytes, size_t alignment) {
+    auto offset = huge_page_detail::roundUp(used, alignment);
+    if (offset > cap || numBytes > cap - offset)
+      throw std::bad_alloc();
+    used = offset + numBytes;
+    return static_cast<char*>(base) + offset;
+  }
+
+  inline size_t capacity() const noexcept { return cap; }
+  inline size_t bytesUsed() const noexcept { return used; }
+  inline bool usesHugeTlb() const noexcept { return hugeTlb; }
+};
+
+template <class T>
+class ArenaAllocator {
+  template <class U>
+  friend class ArenaAllocator;
+
+  HugePageArena* arena;
+
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  explicit ArenaAllocator(HugePageArena& a) noexcept : arena(&a) {}
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+      : arena(other.arena) {}
+
+  T* allocate(size_t n) {
+    if (n > SIZE_MAX / sizeof(T))
+      throw std::bad_alloc();
+    return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+  }
+  // Chunks are only released with the whole arena
+  void deallocate(T*, size_t) noexcept {}
+
+  // Chunks are never reused, they are still zero when handed out
+  template <class U>
+  void construct(U* p) {
+    huge_page_detail::constructOnZeroedMemory(p);
+  }
+  template <class U, class... Args>
+  void construct(U* p, Args&&... args) {
+    ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+
+  template <class U>
+  bool operator==(const ArenaAllocator<U>& other) const noexcept {
+    return arena == other.arena;
+  }
+};
+
+}  // namespace robinhood
+}  // namespace ykoh
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace ykoh {
+namespace robinhood {
+
+// std::allocator that default initializes instead of value initializing:
+// construct() without arguments leaves trivially default constructible
+// types untouched, so a dynamically sized robinhood_set_fixed of n buckets
+// is allocated without writing them. The buckets are garbage until cleared
+// with reset_buckets(), robinhood_set clears them a slice at a time.
+template <class T>
+class UninitializedAllocator : public std::allocator<T> {
+ public:
+  using value_type = T;
+  template <class U>
+  struct rebind {
+    using other = UninitializedAllocator<U>;
+  };
+
+  UninitializedAllocator() = default;
+  template <class U>
+  UninitializedAllocator(const UninitializedAllocator<U>&) noexcept {}
+
+  template <class U>
+  void construct(U* p) {
+    ::new (static_cast<void*>(p)) U;
+  }
+  template <class U, class... Args>
+  void construct(U* p, Args&&... args) {
+    ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+};
+
+}  // namespace robinhood
+}  // namespace ykoh
@@ -0,0 +1,319 @@
+#pragma once
+
+#include <CapacityPolicy.hpp>
+#include <FixedSizeRobinhoodSet.hpp>
+#include <IntMurMurHash3.hpp>
+#include <KeyTraits.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+namespace ykoh {
+namespace robinhood {
+
+// Buckets of a concurrent_robinhood_set shard: AoSContainer entries kept as
+// arrays of words, every word is loaded and stored with relaxed
+// std::atomic_ref operations. Writers still need to be serialized, but
+// readers may probe concurrently: a bucket copied while a writer modifies it
+// can be torn, the seqlock of the shard tells readers when to retry.
+// Dynamically sized only. Buckets are built from value initialized entries,
+// so their padding is always zero.
+template <class KeyT,
+          size_t N = DYNAMIC_SIZE,
+          class Traits = KeyTraits<KeyT>,
+          class CapacityPolicy = ModuloCapacity,
+          class Allocator = std::allocator<KeyT>>
+struct SeqlockContainer {
+  // Typedefs
+  using KeyType = KeyT;
+  using ProbeSeqLenT = uint32_t;
+  using StoredHashT = typename StoredHashFor<Traits>::type;
+  using SizeT = std::size_t;
+  using PositionT = SizeT;
+  using BucketT = typename AoSContainer<KeyT,
+                                        N,
+                                        Traits,
+                                        CapacityPolicy,
+                                        Allocator>::Entry;
+  // Widest word that evenly divides and is aligned within a bucket
+  using WordT = std::conditional_t<
+      alignof(BucketT) >= 8,
+      uint64_t,
+      std::conditional_t<alignof(BucketT) >= 4, uint32_t, uint16_t>>;
+  using iterator = BucketPositionIterator<SeqlockContainer>;
+  using Entry = typename iterator::KeyRef;
+
+  static_assert(isDynamicAllocSize(N), "Shards are dynamically sized");
+  static_assert(std::is_trivially_copyable_v<BucketT>);
+  static_assert(sizeof(BucketT) % sizeof(WordT) == 0);
+  static_assert(std::atomic_ref<WordT>::is_always_lock_free);
+
+  static constexpr SizeT kWordsPerBucket = sizeof(BucketT) / sizeof(WordT);
+
+  // Members
+  ReboundVectorT<WordT, Allocator> words;
+
+  // Ctrs
+  explicit SeqlockContainer(SizeT fixedCapacity,
+                            const Allocator& alloc = Allocator())
+      : words(CapacityPolicy::roundCapacity(fixedCapacity) * kWordsPerBucket,
+              typename decltype(words)::allocator_type(alloc)) {
+    reset();
+  }
+
+  // Copy of the bucket at pos, possibly torn if a writer is modifying it
+  inline BucketT load(PositionT pos) const noexcept {
+    std::array<WordT, kWordsPerBucket> copy;
+    // atomic_ref only takes non-const objects before C++26, nothing is
+    // written through it
+    auto src = const_cast<WordT*>(&words[pos * kWordsPerBucket]);
+    for (SizeT i = 0; i < kWordsPerBucket; ++i)
+      copy[i] = std::atomic_ref<WordT>(src[i]).load(std::memory_order_relaxed);
+    return std::bit_cast<BucketT>(copy);
+  }
+  inline void store(PositionT pos, const BucketT& b) noexcept {
+    auto copy = std::bit_cast<std::array<WordT, kWordsPerBucket>>(b);
+    auto dst = &words[pos * kWordsPerBucket];
+    for (SizeT i = 0; i < kWordsPerBucket; ++i)
+      std::atomic_ref<WordT>(dst[i]).store(copy[i], std::memory_order_relaxed);
+  }
+
+  // Operations on positions in the container, see AoSContainer
+
+  inline bool isOccupiedAtPos(PositionT pos) const noexcept {
+    return load(pos).isOccupied();
+  }
+  inline bool isEmptyAtPos(PositionT pos) const noexcept {
+    return load(pos).isEmpty();
+  }
+  inline ProbeSeqLenT pslAtPos(PositionT pos) const noexcept {
+    return load(pos).psl;
+  }
+  // Keys are copied out, buckets are only modified through the operations
+  // below
+  inline KeyT keyAtPos(PositionT pos) const noexcept { return load(pos).key; }
+  inline StoredHashT storedHashAtPos(PositionT pos) const noexcept {
+    return load(pos).hash;
+  }
+  inline void placeAtPos(PositionT pos,
+                         KeyT&& k,
+                         StoredHashT hash,
+                         ProbeSeqLenT psl) noexcept {
+    BucketT b{};
+    b.key = k;
+    b.hash = hash;
+    b.psl = psl;
+    b.setOccupied();
+    store(pos, b);
+  }
+  inline void exchangeAtPos(PositionT pos,
+                            KeyT& k,
+                            StoredHashT& hash,
+                            ProbeSeqLenT psl) noexcept {
+    auto b = load(pos);
+    std::swap(b.key, k);
+    std::swap(b.hash, hash);
+    b.psl = psl;
+    store(pos, b);
+  }
+  inline void shiftBackAtPos(PositionT fromPos, PositionT toPos) noexcept {
+    auto b = load(fromPos);
+    b.psl--;
+    store(toPos, b);
+  }
+  inline void setEmptyAtPos(PositionT pos) noexcept {
+    auto b = load(pos);
+    b.setEmpty();
+    store(pos, b);
+  }
+  template <bool ForWrite>
+  inline void prefetchAtPos(PositionT pos) const noexcept {
+    __builtin_prefetch(&words[pos * kWordsPerBucket], ForWrite ? 1 : 0);
+  }
+  void reset() noexcept { resetRange(0, capacity()); }
+  void resetRange(PositionT first, PositionT last) noexcept {
+    for (; first < last; ++first)
+      store(first, BucketT{});
+  }
+
+  inline PositionT capacity() const noexcept {
+    return words.size() / kWordsPerBucket;
+  }
+  inline SizeT memoryUsage() const noexcept {
+    return words.size() * sizeof(WordT);
+  }
+  inline iterator iteratorAt(PositionT pos) noexcept {
+    return iterator(this, pos);
+  }
+  inline PositionT positionOf(iterator it) noexcept { return it.position(); }
+};
+
+struct SeqlockLayout {
+  template <class Key,
+            size_t N,
+            class Traits,
+            class CapacityPolicy,
+            class Allocator>
+  using Container = SeqlockContainer<Key, N, Traits, CapacityPolicy, Allocator>;
+};
+
+// Concurrent robinhood set, partitioned into shards that are each backed by
+// a fixed size robinhood_set_fixed.
+//
+// Writers (insert/erase) take the mutex of their shard, so writers only
+// contend when they hit the same shard. Readers (contains) never lock nor
+// write: each shard has a seqlock version counter that writers bump to an
+// odd value before and back to an even value after modifying the shard, and
+// readers retry whenever the version was odd or changed during the probe.
+//
+// Shards use SeqlockLayout: writers store and readers load buckets one word
+// at a time with relaxed std::atomic_ref operations, so readers run the
+// shard's own probe (contains_with_hash) without racing with writers. A
+// probe that saw a torn bucket is discarded by the version check, which is
+// why keys must be trivially copyable. Probes stay in bounds regardless
+// since the capacity of a shard never changes.
+//
+// Keys are hashed once: the hash picks the shard and is handed down to the
+// shard's set.
+template <class Key,
+          class Traits = KeyTraits<Key>,
+          class CapacityPolicy = ModuloCapacity>
+class concurrent_robinhood_set {
+  static_assert(std::is_trivially_copyable_v<Key>,
+                "Optimistic readers require trivially copyable keys");
+
+  // Typedefs
+  using HasherFunc = typename Traits::Hasher;
+  using SetT = robinhood_set_fixed<Key,
+                                   DYNAMIC_SIZE,
+                                   Traits,
+                                   CapacityPolicy,
+                                   NoStats,
+                                   SeqlockLayout>;
+  using VersionT = uint64_t;
+  using SizeT = size_t;
+
+  static constexpr SizeT kCacheLineSize = 64;
+  static constexpr SizeT kDefaultNumShards = 64;
+
+  // Each shard starts on its own cache line, so that the version counter and
+  // mutex of a shard never share a line with those of another shard
+  struct alignas(kCacheLineSize) Shard {
+    std::atomic<VersionT> version{0};
+    std::mutex writeMutex;
+    SetT set{0};
+  };
+
+  // Increments the version on construction and destruction, under the
+  // shard's write mutex
+  class WriteGuard {
+    Shard& shard;
+    std::lock_guard<std::mutex> lock;
+
+   public:
+    explicit WriteGuard(Shard& s) : shard(s), lock(s.writeMutex) {
+      auto v = shard.version.load(std::memory_order_relaxed);
+      shard.version.store(v + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+    ~WriteGuard() {
+      auto v = shard.version.load(std::memory_order_relaxed);
+      shard.version.store(v + 1, std::memory_order_release);
+    }
+  };
+
+  // Members
+  SizeT numShards;
+  std::unique_ptr<Shard[]> shards;
+
+  // Private methods
+  // Shards are picked from a remix of the hash, so that keys of a shard do
+  // not share the bits that the shard's own CapacityPolicy relies on
+  inline Shard& shardFor(size_t hash) const noexcept {
+    auto shardHash = IntMurMurHash3{}(hash ^ 0x9e3779b97f4a7c15);
+    return shards[shardHash & (numShards - 1)];
+  }
+
+ public:
+  using key_type = Key;
+
+  // numShards is rounded up to a power of two, and totalCapacity is split
+  // evenly across the shards
+  explicit concurrent_robinhood_set(SizeT totalCapacity,
+                                    SizeT numShardsHint = kDefaultNumShards)
+      : numShards(std::bit_ceil(std::max<SizeT>(numShardsHint, 1))),
+        shards(new Shard[numShards]) {
+    if (totalCapacity < numShards)
+      throw std::invalid_argument("Capacity is smaller than the shard count");
+    auto shardCapacity = (totalCapacity + numShards - 1) / numShards;
+    for (SizeT i = 0; i < numShards; ++i)
+      shards[i].set = SetT{shardCapacity};
+  }
+
+  // Returns true if inserted, false if already present or the shard is full
+  bool insert(const Key& k) {
+    auto hash = HasherFunc{}(k);
+    auto& shard = shardFor(hash);
+    WriteGuard guard(shard);
+    return shard.set.insert_with_hash(k, hash);
+  }
+
+  // Returns true if the key was found and erased
+  bool erase(const Key& k) {
+    auto hash = HasherFunc{}(k);
+    auto& shard = shardFor(hash);
+    WriteGuard guard(shard);
+    return shard.set.erase_with_hash(k, hash);
+  }
+
+  // Lock-free optimistic read, retried until no writer interfered
+  bool contains(const Key& k) const noexcept {
+    auto hash = HasherFunc{}(k);
+    auto& shard = shardFor(hash);
+    while (true) {
+      auto before = shard.version.load(std::memory_order_acquire);
+      if (before & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+      bool found = shard.set.contains_with_hash(k, hash);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (shard.version.load(std::memory_order_relaxed) == before)
+        return found;
+    }
+  }
+
+  // Sum of the shard sizes, only exact if there are no concurrent writers
+  SizeT size() const noexcept {
+    SizeT total = 0;
+    for (SizeT i = 0; i < numShards; ++i) {
+      std::lock_guard<std::mutex> lock(shards[i].writeMutex);
+      total += shards[i].set.size();
+    }
+    return total;
+  }
+
+  SizeT capacity() const noexcept {
+    return numShards * shards[0].set.capacity();
+  }
+  SizeT shard_count() const noexcept {
+    return numShards;
+  }
+
+  void clear() {
+    for (SizeT i = 0; i < numShards; ++i) {
+      WriteGuard guard(shards[i]);
+      shards[i].set.clear();
+    }
+  }
+};
+}  // namespace robinhood
+}  // namespace ykoh
@@ -1,10 +1,20 @@
 #pragma once
 
+#include <CapacityPolicy.hpp>
 #include <KeyTraits.hpp>
+#include <StatsPolicy.hpp>
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #define DEBUG 0
@@ -26,240 +36,1369 @@ static consteval bool isStaticAllocSize(size_t N) {
   return N > 0;
 }
 
-// Memory layout choices
-// Single Flat array containing keys only, PSL not stored
-template <class KeyT, size_t N = DYNAMIC_SIZE, class Traits = KeyTraits<KeyT>>
-struct KeyOnlyContainer {
+// Hash cached beside each key when Traits ask for it (StoredHashKeyTraits)
+// NoStoredHash takes no room in the buckets, [[no_unique_address]]
+struct NoStoredHash {
+  constexpr bool operator==(const NoStoredHash&) const = default;
+};
+template <class Traits>
+struct StoredHashFor {
+  using type = NoStoredHash;
+};
+template <class Traits>
+requires StoredHashTraits<Traits> struct StoredHashFor<Traits> {
+  using type = typename Traits::StoredHashT;
+};
+template <class StoredHashT>
+inline constexpr StoredHashT toStoredHash(size_t hash) noexcept {
+  if constexpr (std::is_same_v<StoredHashT, NoStoredHash>)
+    return NoStoredHash{};
+  else
+    return static_cast<StoredHashT>(hash);
+}
+
+// Memory layout choices, selected with the Layout parameter of
+// robinhood_set_fixed. All layouts hold the same buckets and give the same
+// results, they only differ in where the fields of a bucket live:
+//  - AoSLayout:     one array of Entry {key, occupied, psl, cached hash},
+//                   a probe reads a single entry (default)
+//  - SoALayout:     one array per field, probes scan the dense PSL array
+//                   and only read the keys of candidate buckets
+//  - KeyOnlyLayout: keys plus an occupancy bitmap, PSL not stored but
+//                   computed on the fly from the hash of the key
+// Containers are accessed by bucket position, see AoSContainer for the
+// operations every container provides.
+// Dynamically sized containers allocate every array with Allocator, rebound
+// to the element type (see HugePageAllocator.hpp).
+
+template <class T, class Allocator>
+using ReboundVectorT = std::vector<
+    T,
+    typename std::allocator_traits<Allocator>::template rebind_alloc<T>>;
+
+template <class T, size_t N, class CapacityPolicy, class Allocator>
+using BucketArrayT =
+    std::conditional_t<isDynamicAllocSize(N),
+                       ReboundVectorT<T, Allocator>,
+                       std::array<T, CapacityPolicy::roundCapacity(N)>>;
+
+// Array of cached hashes, or nothing at all if Traits cache none
+template <class StoredHashT, size_t N, class CapacityPolicy, class Allocator>
+using StoredHashArrayT =
+    std::conditional_t<std::is_same_v<StoredHashT, NoStoredHash>,
+                       NoStoredHash,
+                       BucketArrayT<StoredHashT, N, CapacityPolicy, Allocator>>;
+
+template <class ArrayT, class Allocator>
+inline ArrayT makeBucketArray(size_t numElems, const Allocator& alloc) {
+  if constexpr (std::is_same_v<ArrayT, NoStoredHash>)
+    return NoStoredHash{};
+  else
+    return ArrayT(numElems, typename ArrayT::allocator_type(alloc));
+}
+
+// Iterator of the containers without an Entry struct: it->key is the key of
+// the bucket at position()
+template <class Container>
+class BucketPositionIterator {
+  using KeyT = typename Container::KeyType;
+  Container* container{nullptr};
+  size_t pos{0};
+
+ public:
+  struct KeyRef {
+    KeyT& key;
+  };
+  struct ArrowProxy {
+    KeyRef ref;
+    constexpr const KeyRef* operator->() const noexcept { return &ref; }
+  };
+
+  constexpr BucketPositionIterator() = default;
+  constexpr BucketPositionIterator(Container* c, size_t p)
+      : container(c), pos(p) {}
+  constexpr KeyRef operator*() const noexcept {
+    return KeyRef{container->keyAtPos(pos)};
+  }
+  constexpr ArrowProxy operator->() const noexcept {
+    return ArrowProxy{**this};
+  }
+  constexpr BucketPositionIterator& operator++() noexcept {
+    return ++pos, *this;
+  }
+  constexpr bool operator==(const BucketPositionIterator& other) const {
+    return pos == other.pos && container == other.container;
+  }
+  constexpr size_t position() const noexcept { return pos; }
+};
+
+// Array of entries, each entry stores its PSL
+template <class KeyT,
+          size_t N = DYNAMIC_SIZE,
+          class Traits = KeyTraits<KeyT>,
+          class CapacityPolicy = ModuloCapacity,
+          class Allocator = std::allocator<KeyT>>
+struct AoSContainer {
   // Typedefs
+  using KeyType = KeyT;
   using OccupiedFlag = bool;
   using ProbeSeqLenT = uint32_t;
-  using HasherFunc = typename Traits::Hasher;
-  using KeyEqualCmpFunc = typename Traits::EqualTo;
+  using StoredHashT = typename StoredHashFor<Traits>::type;
   using SizeT = std::size_t;
+  using PositionT = SizeT;
 
   struct Entry {
-    // Members
-    OccupiedFlag occupied;
     KeyT key;
-    // Ctrs
-    constexpr Entry() = default;
-    constexpr Entry(KeyT k) : key(std::move(k)), occupied{true} {}
-    // Methods
-    void constexpr reset() noexcept { occupied = false; }
+    OccupiedFlag occupied : 1;
+    ProbeSeqLenT psl : 31;
+    [[no_unique_address]] StoredHashT hash;
+
     inline constexpr bool isOccupied() const noexcept { return occupied; }
     inline constexpr bool isEmpty() const noexcept { return !isOccupied(); }
     inline constexpr void setOccupied() noexcept { occupied = true; }
     inline constexpr void setEmpty() noexcept { occupied = false; }
+    inline constexpr void reset() noexcept {
+      setEmpty();
+      psl = 0;
+      // Note key is not reset
+    }
+    constexpr Entry() = default;
   };
 
-  using ContainerT = std::conditional_t<isDynamicAllocSize(N),
-                                        std::vector<Entry>,
-                                        std::array<Entry, N>>;
+  using ContainerT = BucketArrayT<Entry, N, CapacityPolicy, Allocator>;
+  using iterator = typename ContainerT::iterator;
+
+  // Members
+  ContainerT entries;
+
+  // Ctrs
+  template <size_t _N = N>
+  requires(isStaticAllocSize(_N)) constexpr AoSContainer() : entries{} {}
+
+  template <size_t _N = N>
+  requires(isDynamicAllocSize(_N)) constexpr explicit AoSContainer(
+      SizeT fixedCapacity,
+      const Allocator& alloc = Allocator())
+      : entries(CapacityPolicy::roundCapacity(fixedCapacity),
+                typename ContainerT::allocator_type(alloc)) {}
+
+  // Operations on positions in the container
+
+  inline constexpr bool isOccupiedAtPos(PositionT pos) const noexcept {
+    return entries[pos].isOccupied();
+  }
+  inline constexpr bool isEmptyAtPos(PositionT pos) const noexcept {
+    return entries[pos].isEmpty();
+  }
+  inline constexpr ProbeSeqLenT pslAtPos(PositionT pos) const noexcept {
+    return entries[pos].psl;
+  }
+  inline constexpr KeyT& keyAtPos(PositionT pos) noexcept {
+    return entries[pos].key;
+  }
+  inline constexpr const KeyT& keyAtPos(PositionT pos) const noexcept {
+    return entries[pos].key;
+  }
+  inline constexpr StoredHashT storedHashAtPos(PositionT pos) const noexcept {
+    return entries[pos].hash;
+  }
+  // Fills the empty bucket at pos
+  inline constexpr void placeAtPos(PositionT pos,
+                                   KeyT&& k,
+                                   StoredHashT hash,
+                                   ProbeSeqLenT psl) {
+    auto& e = entries[pos];
+    e.key = std::move(k);
+    e.hash = hash;
+    e.psl = psl;
+    e.setOccupied();
+  }
+  // Stores (k, hash, psl) in the occupied bucket at pos, the key and hash it
+  // held are handed back through k and hash
+  inline constexpr void exchangeAtPos(PositionT pos,
+                                      KeyT& k,
+                                      StoredHashT& hash,
+                                      ProbeSeqLenT psl) {
+    auto& e = entries[pos];
+    std::swap(e.key, k);
+    std::swap(e.hash, hash);
+    e.psl = psl;
+  }
+  // Moves the entry at fromPos one step back to toPos, decrementing its PSL
+  inline constexpr void shiftBackAtPos(PositionT fromPos, PositionT toPos) {
+    entries[toPos] = std::move(entries[fromPos]);
+    entries[toPos].psl--;
+  }
+  inline constexpr void setEmptyAtPos(PositionT pos) noexcept {
+    entries[pos].setEmpty();
+  }
+  template <bool ForWrite>
+  inline void prefetchAtPos(PositionT pos) const noexcept {
+    __builtin_prefetch(&entries[pos], ForWrite ? 1 : 0);
+  }
+  void reset() noexcept {
+    for (auto& e : entries)
+      e.reset();
+  }
+  // Empties [first, last) only, regions of the same container can be reset
+  // concurrently
+  void resetRange(PositionT first, PositionT last) noexcept {
+    for (; first < last; ++first)
+      entries[first].reset();
+  }
+
+  inline constexpr PositionT capacity() const noexcept {
+    return entries.size();
+  }
+  inline constexpr SizeT memoryUsage() const noexcept {
+    return capacity() * sizeof(Entry);
+  }
+  inline constexpr iterator iteratorAt(PositionT pos) noexcept {
+    return entries.begin() + pos;
+  }
+  inline constexpr PositionT positionOf(iterator it) noexcept {
+    return std::distance(entries.begin(), it);
+  }
+};
+
+// One array per field: keys, PSLs (0 if empty, psl + 1 otherwise) and
+// cached hashes if any
+template <class KeyT,
+          size_t N = DYNAMIC_SIZE,
+          class Traits = KeyTraits<KeyT>,
+          class CapacityPolicy = ModuloCapacity,
+          class Allocator = std::allocator<KeyT>>
+struct SoAContainer {
+  // Typedefs
+  using KeyType = KeyT;
+  using ProbeSeqLenT = uint32_t;
+  using StoredHashT = typename StoredHashFor<Traits>::type;
+  using SizeT = std::size_t;
+  using PositionT = SizeT;
+  using iterator = BucketPositionIterator<SoAContainer>;
+  using Entry = typename iterator::KeyRef;
+  using HashesT = StoredHashArrayT<StoredHashT, N, CapacityPolicy, Allocator>;
+
+  // Members
+  BucketArrayT<ProbeSeqLenT, N, CapacityPolicy, Allocator> metas;
+  BucketArrayT<KeyT, N, CapacityPolicy, Allocator> keys;
+  [[no_unique_address]] HashesT hashes;
+
+  // Ctrs
+  template <size_t _N = N>
+  requires(isStaticAllocSize(_N)) constexpr SoAContainer()
+      : metas{}, keys{}, hashes{} {}
+
+  template <size_t _N = N>
+  requires(isDynamicAllocSize(_N)) constexpr explicit SoAContainer(
+      SizeT fixedCapacity,
+      const Allocator& alloc = Allocator())
+      : metas(makeBucketArray<decltype(metas)>(
+            CapacityPolicy::roundCapacity(fixedCapacity), alloc)),
+        keys(makeBucketArray<decltype(keys)>(metas.size(), alloc)),
+        hashes(makeBucketArray<HashesT>(metas.size(), alloc)) {}
+
+  // Operations on positions in the container
+
+  inline constexpr bool isOccupiedAtPos(PositionT pos) const noexcept {
+    return metas[pos] != 0;
+  }
+  inline constexpr bool isEmptyAtPos(PositionT pos) const noexcept {
+    return metas[pos] == 0;
+  }
+  inline constexpr ProbeSeqLenT pslAtPos(PositionT pos) const noexcept {
+    return metas[pos] - 1;
+  }
+  inline constexpr KeyT& keyAtPos(PositionT pos) noexcept {
+    return keys[pos];
+  }
+  inline constexpr const KeyT& keyAtPos(PositionT pos) const noexcept {
+    return keys[pos];
+  }
+  inline constexpr StoredHashT storedHashAtPos(PositionT pos) const noexcept {
+    if constexpr (std::is_same_v<StoredHashT, NoStoredHash>)
+      return NoStoredHash{};
+    else
+      return hashes[pos];
+  }
+  inline constexpr void placeAtPos(PositionT pos,
+                                   KeyT&& k,
+                                   StoredHashT hash,
+                                   ProbeSeqLenT psl) {
+    keys[pos] = std::move(k);
+    metas[pos] = psl + 1;
+    if constexpr (!std::is_same_v<StoredHashT, NoStoredHash>)
+      hashes[pos] = hash;
+  }
+  inline constexpr void exchangeAtPos(PositionT pos,
+                                      KeyT& k,
+                                      StoredHashT& hash,
+                                      ProbeSeqLenT psl) {
+    std::swap(keys[pos], k);
+    metas[pos] = psl + 1;
+    if constexpr (!std::is_same_v<StoredHashT, NoStoredHash>)
+      std::swap(hashes[pos], hash);
+  }
+  inline constexpr void shiftBackAtPos(PositionT fromPos, PositionT toPos) {
+    keys[toPos] = std::move(keys[fromPos]);
+    metas[toPos] = metas[fromPos] - 1;
+    if constexpr (!std::is_same_v<StoredHashT, NoStoredHash>)
+      hashes[toPos] = hashes[fromPos];
+  }
+  inline constexpr void setEmptyAtPos(PositionT pos) noexcept {
+    metas[pos] = 0;
+  }
+  template <bool ForWrite>
+  inline void prefetchAtPos(PositionT pos) const noexcept {
+    __builtin_prefetch(&metas[pos], ForWrite ? 1 : 0);
+    __builtin_prefetch(&keys[pos], ForWrite ? 1 : 0);
+  }
+  void reset() noexcept { std::fill(metas.begin(), metas.end(), 0); }
+  void resetRange(PositionT first, PositionT last) noexcept {
+    std::fill(metas.begin() + first, metas.begin() + last, 0);
+  }
+
+  inline constexpr PositionT capacity() const noexcept { return metas.size(); }
+  inline constexpr SizeT memoryUsage() const noexcept {
+    SizeT hashSize = 0;
+    if constexpr (!std::is_same_v<StoredHashT, NoStoredHash>)
+      hashSize = sizeof(StoredHashT);
+    return capacity() * (sizeof(ProbeSeqLenT) + sizeof(KeyT) + hashSize);
+  }
+  inline constexpr iterator iteratorAt(PositionT pos) noexcept {
+    return iterator(this, pos);
+  }
+  inline constexpr PositionT positionOf(iterator it) noexcept {
+    return it.position();
+  }
+};
+
+// Flat array containing keys only plus an occupancy bitmap, PSL not stored
+// but computed from the hash of the key, the cached one if it is full
+template <class KeyT,
+          size_t N = DYNAMIC_SIZE,
+          class Traits = KeyTraits<KeyT>,
+          class CapacityPolicy = ModuloCapacity,
+          class Allocator = std::allocator<KeyT>>
+struct KeyOnlyContainer {
+  // Typedefs
+  using KeyType = KeyT;
+  using ProbeSeqLenT = uint32_t;
+  using HasherFunc = typename Traits::Hasher;
+  using StoredHashT = typename StoredHashFor<Traits>::type;
+  using SizeT = std::size_t;
   using PositionT = SizeT;
+  using iterator = BucketPositionIterator<KeyOnlyContainer>;
+  using Entry = typename iterator::KeyRef;
+  using HashesT = StoredHashArrayT<StoredHashT, N, CapacityPolicy, Allocator>;
+  using OccupancyT =
+      std::conditional_t<isDynamicAllocSize(N),
+                         ReboundVectorT<uint64_t, Allocator>,
+                         std::array<uint64_t,
+                                    (CapacityPolicy::roundCapacity(N) + 63) /
+                                        64>>;
 
   // Members
-  ContainerT buckets;
+  BucketArrayT<KeyT, N, CapacityPolicy, Allocator> keys;
+  OccupancyT occupancy;
+  [[no_unique_address]] HashesT hashes;
 
   // Ctrs
   template <size_t _N = N>
-  requires(isStaticAllocSize(_N)) constexpr KeyOnlyContainer() : buckets{} {}
+  requires(isStaticAllocSize(_N)) constexpr KeyOnlyContainer()
+      : keys{}, occupancy{}, hashes{} {}
 
   // Param construct enabled only if using dynamic alloc (uses std::vector)
   template <size_t _N = N>
   requires(isDynamicAllocSize(_N)) constexpr explicit KeyOnlyContainer(
-      SizeT fixedCapacity)
-      : buckets(fixedCapacity) {}
+      SizeT fixedCapacity,
+      const Allocator& alloc = Allocator())
+      : keys(makeBucketArray<decltype(keys)>(
+            CapacityPolicy::roundCapacity(fixedCapacity), alloc)),
+        occupancy(makeBucketArray<OccupancyT>((keys.size() + 63) / 64, alloc)),
+        hashes(makeBucketArray<HashesT>(keys.size(), alloc)) {}
 
   // Operations on positions in the container
 
-  inline constexpr bool occupiedAtPos(PositionT pos) noexcept {
-    return buckets[pos].isOccupied();
+  inline constexpr bool isOccupiedAtPos(PositionT pos) const noexcept {
+    return (occupancy[pos / 64] >> (pos % 64)) & 1;
+  }
+  inline constexpr bool isEmptyAtPos(PositionT pos) const noexcept {
+    return !isOccupiedAtPos(pos);
   }
 
-  // Calculate PSL on the fly
-  inline constexpr PositionT pslAtPos(PositionT pos) {
-    auto homePos = HasherFunc{}(buckets[pos].key) % capacity();
+  // Calculate PSL on the fly, from the cached hash if there is a full one
+  inline constexpr ProbeSeqLenT pslAtPos(PositionT pos) const {
+    auto homePos = CapacityPolicy::reduce(hashAtPos(pos), capacity());
     if (pos < homePos)
       pos += capacity();
-    return pos - homePos;
+    return static_cast<ProbeSeqLenT>(pos - homePos);
   }
 
-  inline constexpr KeyT& keyAtPos(PositionT pos) noexcept {
-    return buckets[pos].key;
+  inline constexpr size_t hashAtPos(PositionT pos) const {
+    if constexpr (FullStoredHashTraits<Traits>)
+      return hashes[pos];
+    else
+      return HasherFunc{}(keys[pos]);
   }
 
-  inline constexpr bool isOccupiedAtPos(PositionT pos) noexcept {
-    return buckets[pos].isOccupied();
+  inline constexpr KeyT& keyAtPos(PositionT pos) noexcept { return keys[pos]; }
+  inline constexpr const KeyT& keyAtPos(PositionT pos) const noexcept {
+    return keys[pos];
   }
-  inline constexpr bool isEmptyAtPos(PositionT pos) noexcept {
-    return buckets[pos].isEmpty();
+  inline constexpr StoredHashT storedHashAtPos(PositionT pos) const noexcept {
+    if constexpr (std::is_same_v<StoredHashT, NoStoredHash>)
+      return NoStoredHash{};
+    else
+      return hashes[pos];
   }
-  inline constexpr bool setOccupiedAtPos(PositionT pos) noexcept {
-    return buckets[pos].setOccupied();
+  // The PSL is implied by the position and the hash of the key
+  inline constexpr void placeAtPos(PositionT pos,
+                                   KeyT&& k,
+                                   StoredHashT hash,
+                                   ProbeSeqLenT) {
+    keys[pos] = std::move(k);
+    occupancy[pos / 64] |= uint64_t{1} << (pos % 64);
+    if constexpr (!std::is_same_v<StoredHashT, NoStoredHash>)
+      hashes[pos] = hash;
   }
-  inline constexpr bool setEmptyAtPos(PositionT pos) noexcept {
-    return buckets[pos].setEmpty();
+  inline constexpr void exchangeAtPos(PositionT pos,
+                                      KeyT& k,
+                                      StoredHashT& hash,
+                                      ProbeSeqLenT) {
+    std::swap(keys[pos], k);
+    if constexpr (!std::is_same_v<StoredHashT, NoStoredHash>)
+      std::swap(hashes[pos], hash);
   }
-  inline constexpr PositionT capacity() const noexcept {
-    return buckets.size();
+  // toPos is occupied already
+  inline constexpr void shiftBackAtPos(PositionT fromPos, PositionT toPos) {
+    keys[toPos] = std::move(keys[fromPos]);
+    if constexpr (!std::is_same_v<StoredHashT, NoStoredHash>)
+      hashes[toPos] = hashes[fromPos];
+  }
+  inline constexpr void setEmptyAtPos(PositionT pos) noexcept {
+    occupancy[pos / 64] &= ~(uint64_t{1} << (pos % 64));
+  }
+  template <bool ForWrite>
+  inline void prefetchAtPos(PositionT pos) const noexcept {
+    __builtin_prefetch(&keys[pos], ForWrite ? 1 : 0);
+  }
+  void reset() noexcept {
+    std::fill(occupancy.begin(), occupancy.end(), uint64_t{0});
   }
-  inline constexpr void swapElemsAtPos(PositionT posX, PositionT posY) {
-    std::swap(buckets[posX], buckets[posY]);
+  // Whole words are cleared at once, a range starting and ending on a
+  // multiple of 64 shares no word with the rest of the bitmap
+  void resetRange(PositionT first, PositionT last) noexcept {
+    for (; first < last && first % 64 != 0; ++first)
+      setEmptyAtPos(first);
+    for (; first + 64 <= last; first += 64)
+      occupancy[first / 64] = 0;
+    for (; first < last; ++first)
+      setEmptyAtPos(first);
+  }
+
+  inline constexpr PositionT capacity() const noexcept { return keys.size(); }
+  inline constexpr SizeT memoryUsage() const noexcept {
+    SizeT hashSize = 0;
+    if constexpr (!std::is_same_v<StoredHashT, NoStoredHash>)
+      hashSize = sizeof(StoredHashT);
+    return capacity() * (sizeof(KeyT) + hashSize) +
+           occupancy.size() * sizeof(uint64_t);
+  }
+  inline constexpr iterator iteratorAt(PositionT pos) noexcept {
+    return iterator(this, pos);
+  }
+  inline constexpr PositionT positionOf(iterator it) noexcept {
+    return it.position();
   }
-  inline constexpr auto end() const noexcept { return buckets.end(); }
 };
 
-template <class Key, size_t N = DYNAMIC_SIZE, class Traits = KeyTraits<Key>>
+struct AoSLayout {
+  template <class Key,
+            size_t N,
+            class Traits,
+            class CapacityPolicy,
+            class Allocator>
+  using Container = AoSContainer<Key, N, Traits, CapacityPolicy, Allocator>;
+};
+struct SoALayout {
+  template <class Key,
+            size_t N,
+            class Traits,
+            class CapacityPolicy,
+            class Allocator>
+  using Container = SoAContainer<Key, N, Traits, CapacityPolicy, Allocator>;
+};
+struct KeyOnlyLayout {
+  template <class Key,
+            size_t N,
+            class Traits,
+            class CapacityPolicy,
+            class Allocator>
+  using Container = KeyOnlyContainer<Key, N, Traits, CapacityPolicy, Allocator>;
+};
+
+// CapacityPolicy (see CapacityPolicy.hpp) decides how hashes are reduced to
+// home positions. With PowerOfTwoCapacity, N or the requested capacity is
+// rounded up to the next power of two.
+// StatsPolicy (see StatsPolicy.hpp) is notified of probes, swaps and
+// backshifts, use CountingStats to enable stats().
+// With StoredHashKeyTraits, each bucket also caches the hash of its key, key
+// comparisons are skipped when the cached hashes differ and
+// insert_with_hash() lets a growing table move keys without rehashing them.
+// Layout (AoSLayout, SoALayout or KeyOnlyLayout, see above) decides how the
+// buckets are laid out in memory, data() and EntryT are the raw entries of
+// AoSLayout only.
+// Allocator allocates the buckets of dynamically sized sets, see
+// HugePageAllocator.hpp for huge page backed allocators.
+template <class Key,
+          size_t N = DYNAMIC_SIZE,
+          class Traits = KeyTraits<Key>,
+          class CapacityPolicy = ModuloCapacity,
+          class StatsPolicy = NoStats,
+          class Layout = AoSLayout,
+          class Allocator = std::allocator<Key>>
 requires(isDynamicAllocSize(N) or
          isStaticAllocSize(N)) class robinhood_set_fixed {
   // Typedefs
   using HasherFunc = typename Traits::Hasher;
   using KeyEqualCmpFunc = typename Traits::EqualTo;
+  using StoredHashT = typename StoredHashFor<Traits>::type;
   using ProbeSeqLenT = uint32_t;
-  using OccupiedFlag = bool;
   using PositionT = size_t;
   using SizeT = size_t;
-  // Private entry struct
-  struct Entry {
-    Key key;
-    OccupiedFlag occupied : 1;
-    ProbeSeqLenT psl : 31;
+  using ContainerT = typename Layout::
+      template Container<Key, N, Traits, CapacityPolicy, Allocator>;
+  using BucketIterT = typename ContainerT::iterator;
 
-    inline constexpr bool isOccupied() const noexcept { return occupied; }
-    inline constexpr bool isEmpty() const noexcept { return !isOccupied(); }
-    inline constexpr void setOccupied() noexcept { occupied = true; }
-    inline constexpr void setEmpty() noexcept { occupied = false; }
-    inline constexpr void reset() noexcept {
-      setEmpty();
-      psl = 0;
-      // Note key is not reset
-    }
-    constexpr Entry() = default;
-    constexpr Entry(Key k) : key(std::move(k)), occupied{true}, psl{0} {}
-  };
-
-  using BucketsT = std::conditional_t<isDynamicAllocSize(N),
-                                      std::vector<Entry>,
-                                      std::array<Entry, N>>;
-  using BucketIterT = typename BucketsT::iterator;
+  static constexpr SizeT kBatchBlock = 32;
+  // Below this many keys per thread, bulk builds use fewer threads
+  static constexpr SizeT kMinKeysPerThread = 4096;
+  // Below this many bytes of buckets, batched lookups are not interleaved
+  static constexpr SizeT kInterleaveMinBytes = SizeT{1} << 20;
+  static constexpr bool kIsAoS = std::is_same_v<Layout, AoSLayout>;
 
   // Members
   SizeT sz{0};
-  BucketsT buckets;
+  ContainerT buckets;
+  [[no_unique_address]] StatsPolicy statsCounters;
 
   // Private methods
-  inline constexpr PositionT computeHomePosition(const Key& k) const {
-    return HasherFunc{}(k) % capacity();
+  template <class K>
+  inline constexpr PositionT computeHomePosition(const K& k) const {
+    return homePositionOf(HasherFunc{}(k));
+  }
+  inline constexpr PositionT homePositionOf(size_t hash) const {
+    return CapacityPolicy::reduce(hash, capacity());
   }
   inline constexpr void advancePosition(PositionT& pos) const {
-    if (++pos >= capacity())
-      pos -= capacity();
+    pos = CapacityPolicy::next(pos, capacity());
   }
-  auto begin() noexcept { return buckets.begin(); }
+  auto begin() noexcept { return buckets.iteratorAt(0); }
 
-#if DEBUG
-  void printEntryAtBucket(const Entry& e, PositionT bucketPos) {
-    std::cout << "Entry (key = " << e.key << ", bucket = " << bucketPos
-              << ", psl = " << e.psl
-              << ", occupied = " << (e.isOccupied() ? "YES" : "EMPTY")
-              << ", home = " << computeHomePosition(e.key) << ")\n";
+  // Full hash of the key at pos, the cached one if there is one
+  inline size_t hashAtPos(PositionT pos) const {
+    if constexpr (FullStoredHashTraits<Traits>)
+      return buckets.storedHashAtPos(pos);
+    else
+      return HasherFunc{}(buckets.keyAtPos(pos));
+  }
+  inline PositionT homePositionAtPos(PositionT pos) const {
+    auto psl = buckets.pslAtPos(pos);
+    return pos >= psl ? pos - psl : pos + capacity() - psl;
   }
-#endif
 
- public:
-  using EntryT = Entry;
-  // Default construct enabled only if using static alloc
-  // Note that for SFINAE to work, it has to check based on template params
-  // of the function itself, not at the class level. Hence we use _N = N
-  template <size_t _N = N>
-  requires(isStaticAllocSize(_N)) constexpr robinhood_set_fixed() : buckets{} {}
+  // Compares the cached hashes first, if any, then the keys
+  template <class K>
+  inline bool matchesAtPos(PositionT pos,
+                           const K& k,
+                           StoredHashT storedHash) const noexcept {
+    if (!(buckets.storedHashAtPos(pos) == storedHash))
+      return false;
+    return KeyEqualCmpFunc{}(buckets.keyAtPos(pos), k);
+  }
 
-  // Param construct enabled only if using dynamic alloc (uses std::vector)
-  template <size_t _N = N>
-  requires(isDynamicAllocSize(_N)) constexpr explicit robinhood_set_fixed(
-      SizeT fixedCapacity)
-      : buckets(fixedCapacity) {}
+  inline bool insertFrom(Key k, size_t hash, PositionT insertPos) {
+    return insertStoredFrom(
+        std::move(k), toStoredHash<StoredHashT>(hash), insertPos);
+  }
 
-  // Copies key, returns true if inserted
-  inline bool insert(Key k) {
+  inline bool insertStoredFrom(Key k,
+                               StoredHashT incomingHash,
+                               PositionT insertPos) {
     // full, cannot insert anymore
     if (isFull())
       return false;
 
-    Entry incomingEntry(k);
-    auto insertPos = computeHomePosition(k);
+    ProbeSeqLenT incomingPsl = 0;
     // loop until find an empty spot
-    while (!buckets[insertPos].isEmpty()) {
-      auto& existingEntry = buckets[insertPos];
+    while (!buckets.isEmptyAtPos(insertPos)) {
+      statsCounters.onInsertProbe();
       // already inserted before, return false
-      if (KeyEqualCmpFunc{}(existingEntry.key, incomingEntry.key))
-        return false;
+      if (matchesAtPos(insertPos, k, incomingHash))
+        return statsCounters.onInsert(false), false;
 
-      // If existingEntry.psl >= incomingEntry.psl, it means the
-      // existingEntry's homePos is before/equal to the incomingEntry's
-      // homePos, and thus doesn't require any displacement
+      // If existingPsl >= incomingPsl, it means the existing entry's homePos
+      // is before/equal to the incoming entry's homePos, and thus doesn't
+      // require any displacement
 
       // displace existing element, insert the incoming at this position
-      if (existingEntry.psl < incomingEntry.psl)
-        std::swap(existingEntry, incomingEntry);
+      auto existingPsl = buckets.pslAtPos(insertPos);
+      if (existingPsl < incomingPsl) {
+        statsCounters.onInsertSwap();
+        buckets.exchangeAtPos(insertPos, k, incomingHash, incomingPsl);
+        incomingPsl = existingPsl;
+      }
 
-      ++incomingEntry.psl;
+      ++incomingPsl;
       advancePosition(insertPos);
     }
-    buckets[insertPos] = std::move(incomingEntry);
+    buckets.placeAtPos(insertPos, std::move(k), incomingHash, incomingPsl);
+    statsCounters.onInsert(true);
     return ++sz, true;
   }
 
-  // Find returns an iterator to the Entry
-  inline auto find(const Key& k) noexcept {
-    auto searchPos = computeHomePosition(k);
+  template <class K>
+  inline BucketIterT findFrom(const K& k,
+                              size_t hash,
+                              PositionT searchPos) noexcept {
+    auto storedHash = toStoredHash<StoredHashT>(hash);
     ProbeSeqLenT currPsl = 0;
-    while (currPsl < capacity() && !buckets[searchPos].isEmpty() &&
-           buckets[searchPos].psl >= currPsl) {
-      auto& currEntry = buckets[searchPos];
-      if (KeyEqualCmpFunc{}(currEntry.key, k))
-        return begin() + searchPos;
+    while (currPsl < capacity() && !buckets.isEmptyAtPos(searchPos) &&
+           buckets.pslAtPos(searchPos) >= currPsl) {
+      statsCounters.onFindProbe();
+      if (matchesAtPos(searchPos, k, storedHash))
+        return statsCounters.onFind(true), buckets.iteratorAt(searchPos);
       ++currPsl, advancePosition(searchPos);
     }
+    statsCounters.onFind(false);
     return end();
   }
 
+  // Same as findFrom, without iterator nor find stats: position of k,
+  // capacity() if absent. onProbe() is called for every bucket visited
+  template <class OnProbe>
+  inline PositionT positionFrom(const Key& k,
+                                StoredHashT storedHash,
+                                PositionT searchPos,
+                                OnProbe&& onProbe) const noexcept {
+    ProbeSeqLenT currPsl = 0;
+    while (currPsl < capacity() && !buckets.isEmptyAtPos(searchPos) &&
+           buckets.pslAtPos(searchPos) >= currPsl) {
+      onProbe();
+      if (matchesAtPos(searchPos, k, storedHash))
+        return searchPos;
+      ++currPsl, advancePosition(searchPos);
+    }
+    return capacity();
+  }
+
+  // Probe of erase, counted by onEraseProbe() instead of the find stats
+  inline PositionT erasePositionFrom(const Key& k,
+                                     size_t hash,
+                                     PositionT searchPos) noexcept {
+    return positionFrom(k, toStoredHash<StoredHashT>(hash), searchPos, [&] {
+      statsCounters.onEraseProbe();
+    });
+  }
+
+  // Same as findFrom, without iterator nor stats, for probes on behalf of
+  // another set
+  inline bool containsFrom(const Key& k,
+                           StoredHashT storedHash,
+                           PositionT searchPos) const noexcept {
+    return positionFrom(k, storedHash, searchPos, [] {}) != capacity();
+  }
+
+  // Runs resolve(srcPos, hash, dstHomePos) for every occupied bucket of src,
+  // in bucket order. Like forEachInBatch, buckets are processed in blocks
+  // whose home buckets in dst are prefetched before resolving the block.
+  template <bool ForWrite, class ResolveFunc>
+  static void forEachOccupiedInBatch(const robinhood_set_fixed& src,
+                                     const robinhood_set_fixed& dst,
+                                     ResolveFunc&& resolve) {
+    std::array<PositionT, kBatchBlock> positions;
+    std::array<size_t, kBatchBlock> hashes;
+    std::array<PositionT, kBatchBlock> homes;
+    PositionT pos = 0;
+    while (pos < src.capacity()) {
+      SizeT blockSize = 0;
+      for (; blockSize < kBatchBlock && pos < src.capacity(); ++pos) {
+        if (src.buckets.isEmptyAtPos(pos))
+          continue;
+        positions[blockSize] = pos;
+        hashes[blockSize] = src.hashAtPos(pos);
+        homes[blockSize] = dst.homePositionOf(hashes[blockSize]);
+        dst.buckets.template prefetchAtPos<ForWrite>(homes[blockSize]);
+        ++blockSize;
+      }
+      for (SizeT i = 0; i < blockSize; ++i)
+        resolve(positions[i], hashes[i], homes[i]);
+    }
+  }
+
+  // Position starting a cluster, ie. empty or holding a key at its home
+  // position: from there on, keys are laid out by increasing home position.
+  // Full sets have one too, the bucket after the last one to be filled was
+  // preceded by an empty bucket and thus holds a key at its home position.
+  inline PositionT clusterStart() const noexcept {
+    for (PositionT pos = 0; pos < capacity(); ++pos) {
+      if (buckets.isEmptyAtPos(pos) || buckets.pslAtPos(pos) == 0)
+        return pos;
+    }
+    return 0;
+  }
+
+  // Erases every key for which keep(pos, homePos) is false in a single pass
+  // over the buckets. Instead of backshifting the rest of the cluster once
+  // per erased key, each kept key is moved straight to its final bucket.
+  // Returns the number of keys erased.
+  template <class KeepFunc>
+  SizeT compactIf(KeepFunc&& keep) {
+    auto start = clusterStart();
+    SizeT numErased = 0;
+    // Positions relative to start, ie. not wrapped
+    SizeT nextFree = 0;
+    PositionT pos = start;
+    for (SizeT i = 0; i < capacity(); ++i, advancePosition(pos)) {
+      if (buckets.isEmptyAtPos(pos))
+        continue;
+      auto psl = buckets.pslAtPos(pos);
+      if (!keep(pos, pos >= psl ? pos - psl : pos + capacity() - psl)) {
+        buckets.setEmptyAtPos(pos);
+        statsCounters.onErase(0);
+        ++numErased;
+        continue;
+      }
+      auto home = i - psl;
+      auto target = std::max<SizeT>(home, nextFree);
+      nextFree = target + 1;
+      if (target == i)
+        continue;
+      auto targetPos = start + target;
+      if (targetPos >= capacity())
+        targetPos -= capacity();
+      buckets.placeAtPos(targetPos,
+                         std::move(buckets.keyAtPos(pos)),
+                         buckets.storedHashAtPos(pos),
+                         static_cast<ProbeSeqLenT>(target - home));
+      buckets.setEmptyAtPos(pos);
+    }
+    sz -= numErased;
+    return numErased;
+  }
+
+  // Erases the keys found (or not found) in other
+  SizeT compactByMembership(const robinhood_set_fixed& other, bool keepFound) {
+    if (other.capacity() == capacity()) {
+      // Same shape: a key homed at homePos here is homed there too, and as
+      // compactIf walks home positions in order, so do the probes in other
+      return compactIf([&](PositionT pos, PositionT homePos) {
+        return keepFound == other.containsFrom(buckets.keyAtPos(pos),
+                                               buckets.storedHashAtPos(pos),
+                                               homePos);
+      });
+    }
+    // Different shapes: batched probes, then compact
+    std::vector<uint64_t> found((capacity() + 63) / 64, 0);
+    forEachOccupiedInBatch<false>(
+        *this, other, [&](PositionT pos, size_t hash, PositionT otherHome) {
+          if (other.containsFrom(buckets.keyAtPos(pos),
+                                 toStoredHash<StoredHashT>(hash),
+                                 otherHome))
+            found[pos / 64] |= uint64_t{1} << (pos % 64);
+        });
+    return compactIf([&](PositionT pos, PositionT) {
+      return keepFound == (((found[pos / 64] >> (pos % 64)) & 1) != 0);
+    });
+  }
+
+  // Lookups of a batch, calls found(i, pos) for every key with the position
+  // of keys[i], capacity() if absent. Like forEachInBatch keys are processed
+  // in blocks, but the probes of a block are interleaved: one bucket of each
+  // pending key in turn, prefetching its next bucket, so a long probe does
+  // not hold back the misses of the keys after it. Counted as finds.
+  template <class FoundFunc>
+  inline void lookupInBatch(std::span<const Key> keys,
+                            FoundFunc&& found) noexcept {
+    if (memory_usage() < kInterleaveMinBytes) {
+      // Buckets stay in cache, interleaving would only add bookkeeping
+      forEachInBatch<false>(
+          keys, [&](SizeT i, size_t hash, PositionT homePos) {
+            auto it = findFrom(keys[i], hash, homePos);
+            found(i, it == end() ? capacity() : buckets.positionOf(it));
+          });
+      return;
+    }
+    std::array<StoredHashT, kBatchBlock> storedHashes;
+    std::array<PositionT, kBatchBlock> positions;
+    std::array<ProbeSeqLenT, kBatchBlock> psls;
+    std::array<SizeT, kBatchBlock> pending;
+    for (SizeT base = 0; base < keys.size(); base += kBatchBlock) {
+      auto blockSize = std::min(kBatchBlock, keys.size() - base);
+      for (SizeT i = 0; i < blockSize; ++i) {
+        auto hash = HasherFunc{}(keys[base + i]);
+        storedHashes[i] = toStoredHash<StoredHashT>(hash);
+        positions[i] = homePositionOf(hash);
+        psls[i] = 0;
+        pending[i] = i;
+        buckets.template prefetchAtPos<false>(positions[i]);
+      }
+      for (auto numPending = blockSize; numPending > 0;) {
+        SizeT numKept = 0;
+        for (SizeT j = 0; j < numPending; ++j) {
+          auto i = pending[j];
+          auto& pos = positions[i];
+          if (psls[i] >= capacity() || buckets.isEmptyAtPos(pos) ||
+              buckets.pslAtPos(pos) < psls[i]) {
+            statsCounters.onFind(false);
+            found(base + i, capacity());
+            continue;
+          }
+          statsCounters.onFindProbe();
+          if (matchesAtPos(pos, keys[base + i], storedHashes[i])) {
+            statsCounters.onFind(true);
+            found(base + i, pos);
+            continue;
+          }
+          ++psls[i], advancePosition(pos);
+          buckets.template prefetchAtPos<false>(pos);
+          pending[numKept++] = i;
+        }
+        numPending = numKept;
+      }
+    }
+  }
+
+  // Runs resolve(i, hash, homePos) for every key of a batch, in order.
+  // Keys are processed in blocks of kBatchBlock: home positions of a whole
+  // block are computed and their buckets prefetched before the first probe
+  // of the block is resolved, so that the cache misses overlap. Probes that
+  // modify the set are then resolved one after the other.
+  template <bool ForWrite, class ResolveFunc>
+  inline void forEachInBatch(std::span<const Key> keys, ResolveFunc&& resolve) {
+    std::array<size_t, kBatchBlock> hashes;
+    std::array<PositionT, kBatchBlock> homes;
+    for (SizeT base = 0; base < keys.size(); base += kBatchBlock) {
+      auto blockSize = std::min(kBatchBlock, keys.size() - base);
+      for (SizeT i = 0; i < blockSize; ++i) {
+        hashes[i] = HasherFunc{}(keys[base + i]);
+        homes[i] = homePositionOf(hashes[i]);
+        buckets.template prefetchAtPos<ForWrite>(homes[i]);
+      }
+      for (SizeT i = 0; i < blockSize; ++i)
+        resolve(base + i, hashes[i], homes[i]);
+    }
+  }
+
+  // Clears the bitmap words used for a batch of numKeys keys
+  static inline void resetBitmap(std::span<uint64_t> bitmap, SizeT numKeys) {
+    std::fill_n(bitmap.begin(), (numKeys + 63) / 64, uint64_t{0});
+  }
+  static inline void setBit(std::span<uint64_t> bitmap, SizeT i) {
+    bitmap[i / 64] |= uint64_t{1} << (i % 64);
+  }
+
+  // Runs task(t) for every t in [0, numTasks) on its own thread, task 0 on
+  // the calling thread
+  template <class Task>
+  static void runTasks(SizeT numTasks, const Task& task) {
+    std::vector<std::thread> threads;
+    for (SizeT t = 1; t < numTasks; ++t)
+      threads.emplace_back([&task, t] { task(t); });
+    task(SizeT{0});
+    for (auto& thread : threads)
+      thread.join();
+  }
+  // [begin, end) of the i-th of numSlices even slices of [0, n)
+  static inline std::pair<SizeT, SizeT> sliceOf(SizeT n,
+                                                SizeT numSlices,
+                                                SizeT i) {
+    return {n * i / numSlices, n * (i + 1) / numSlices};
+  }
+
+  // Bulk build behind assign and assign_parallel.
+  // Buckets are split in one region of contiguous home positions per thread,
+  // aligned on 64 buckets. Keys are partitioned by the region of their home
+  // position, stably so that every home group keeps the input order, then
+  // each region sorts, dedups and lays out its own keys concurrently.
+  // The layout of a region only depends on its carry in, the first position
+  // its keys may take, ie. the end of the cluster overflowing from the
+  // previous regions: if its m keys laid out from the region start end at
+  // `base`, then laid out from carry in c they end at max(c + m, base).
+  // Carry ins are thus chained in O(numRegions) before laying out anything.
+  // Keys pushed past the end of their region are placed last, by a
+  // sequential fix-up pass over these overflow chains, so that threads never
+  // write to the same buckets or bitmap words.
+  template <class InputIt>
+  SizeT bulkAssign(InputIt first, InputIt last, SizeT numThreads) {
+    // Homes cannot even be computed without buckets
+    if (capacity() == 0 && first != last)
+      throw std::runtime_error("Too many keys for this robinhood set");
+    struct Staged {
+      size_t hash;
+      Key key;
+    };
+    auto clampThreads = [&numThreads](SizeT numKeys) {
+      numThreads = std::clamp<SizeT>(
+          numThreads, 1, std::max<SizeT>(numKeys / kMinKeysPerThread, 1));
+    };
+
+    std::vector<Staged> staged;
+    using IterCategory =
+        typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
+                                    IterCategory>) {
+      using DiffT = typename std::iterator_traits<InputIt>::difference_type;
+      staged.resize(std::distance(first, last));
+      clampThreads(staged.size());
+      runTasks(numThreads, [&](SizeT t) {
+        auto [begin, end] = sliceOf(staged.size(), numThreads, t);
+        for (auto i = begin; i < end; ++i) {
+          auto it = first + static_cast<DiffT>(i);
+          staged[i] = Staged{HasherFunc{}(*it), *it};
+        }
+      });
+    } else {
+      if constexpr (std::is_base_of_v<std::forward_iterator_tag, IterCategory>)
+        staged.reserve(std::distance(first, last));
+      for (; first != last; ++first)
+        staged.push_back(Staged{HasherFunc{}(*first), *first});
+      clampThreads(staged.size());
+    }
+    const SizeT numKeys = staged.size();
+    const SizeT numBuckets = capacity();
+    auto homeOf = [this](const Staged& e) { return homePositionOf(e.hash); };
+
+    const SizeT regionSize =
+        std::max<SizeT>((numBuckets + numThreads - 1) / numThreads, 1);
+    const SizeT alignedRegionSize = (regionSize + 63) / 64 * 64;
+    const SizeT numRegions = std::max<SizeT>(
+        (numBuckets + alignedRegionSize - 1) / alignedRegionSize, 1);
+    auto regionStart = [&](SizeT r) {
+      return std::min(r * alignedRegionSize, numBuckets);
+    };
+    auto regionOf = [&](const Staged& e) {
+      return homeOf(e) / alignedRegionSize;
+    };
+
+    // Stable partition by region: offsets[r * numThreads + t] is where the
+    // keys of slice t homed in region r go, keys of region r start at
+    // offsets[r * numThreads]
+    std::vector<SizeT> offsets(numRegions * numThreads + 1, 0);
+    runTasks(numThreads, [&](SizeT t) {
+      auto [begin, end] = sliceOf(numKeys, numThreads, t);
+      std::vector<SizeT> counts(numRegions, 0);
+      for (auto i = begin; i < end; ++i)
+        ++counts[regionOf(staged[i])];
+      for (SizeT r = 0; r < numRegions; ++r)
+        offsets[r * numThreads + t + 1] = counts[r];
+    });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<Staged> partitioned(numKeys);
+    runTasks(numThreads, [&](SizeT t) {
+      auto [begin, end] = sliceOf(numKeys, numThreads, t);
+      std::vector<SizeT> cursors(numRegions);
+      for (SizeT r = 0; r < numRegions; ++r)
+        cursors[r] = offsets[r * numThreads + t];
+      for (auto i = begin; i < end; ++i)
+        partitioned[cursors[regionOf(staged[i])]++] = std::move(staged[i]);
+    });
+    auto regionKeysBegin = [&](SizeT r) { return offsets[r * numThreads]; };
+
+    // Per region: counting sort by home position back into staged, order
+    // each home group by hash, so that duplicates are adjacent to keys of
+    // the same hash, and drop duplicates while compacting. Then lay out the
+    // remaining keys from the region start to find where they end.
+    // Positions are linear, ie. not wrapped yet
+    std::vector<SizeT> numUniques(numRegions);
+    std::vector<PositionT> baseCarryOuts(numRegions);
+    runTasks(numRegions, [&](SizeT r) {
+      auto firstPos = regionStart(r);
+      auto numPositions = regionStart(r + 1) - firstPos;
+      auto keysBegin = regionKeysBegin(r), keysEnd = regionKeysBegin(r + 1);
+      std::vector<SizeT> homeOffsets(numPositions + 1, 0);
+      for (auto i = keysBegin; i < keysEnd; ++i)
+        ++homeOffsets[homeOf(partitioned[i]) - firstPos + 1];
+      for (PositionT pos = 0; pos < numPositions; ++pos)
+        homeOffsets[pos + 1] += homeOffsets[pos];
+      {
+        auto cursors = homeOffsets;
+        for (auto i = keysBegin; i < keysEnd; ++i) {
+          auto& e = partitioned[i];
+          staged[keysBegin + cursors[homeOf(e) - firstPos]++] = std::move(e);
+        }
+      }
+
+      auto numUnique = keysBegin;
+      for (PositionT pos = 0; pos < numPositions; ++pos) {
+        auto groupBegin = staged.begin() + keysBegin + homeOffsets[pos];
+        auto groupEnd = staged.begin() + keysBegin + homeOffsets[pos + 1];
+        if (groupEnd - groupBegin > 1)
+          std::sort(groupBegin, groupEnd, [](const auto& a, const auto& b) {
+            return a.hash < b.hash;
+          });
+        auto uniqueGroupBegin = numUnique;
+        for (auto it = groupBegin; it != groupEnd; ++it) {
+          bool isDuplicate = false;
+          for (auto j = numUnique; j-- > uniqueGroupBegin &&
+                                   staged[j].hash == it->hash && !isDuplicate;)
+            isDuplicate = KeyEqualCmpFunc{}(staged[j].key, it->key);
+          if (isDuplicate)
+            continue;
+          if (&staged[numUnique] != &*it)
+            staged[numUnique] = std::move(*it);
+          ++numUnique;
+        }
+      }
+      numUniques[r] = numUnique - keysBegin;
+
+      PositionT nextFree = firstPos;
+      for (auto i = keysBegin; i < numUnique; ++i)
+        nextFree = std::max(homeOf(staged[i]), nextFree) + 1;
+      baseCarryOuts[r] = nextFree;
+    });
+    partitioned = {};
+
+    SizeT numUnique = 0;
+    for (auto n : numUniques)
+      numUnique += n;
+    if (numUnique > numBuckets)
+      throw std::runtime_error("Too many keys for this robinhood set");
+
+    // Keys pushed past the last bucket wrap around to the front and take
+    // precedence over keys homed there. Find how many buckets they take by
+    // iterating to a fixed point, this only grows and usually takes 1 pass.
+    std::vector<PositionT> carryIns(numRegions);
+    SizeT numWrapped = 0;
+    while (true) {
+      PositionT carry = numWrapped;
+      for (SizeT r = 0; r < numRegions; ++r) {
+        carryIns[r] = carry;
+        if (numUniques[r] > 0)
+          carry = std::max(carry + numUniques[r], baseCarryOuts[r]);
+      }
+      auto overflow = carry > numBuckets ? carry - numBuckets : 0;
+      if (overflow == numWrapped)
+        break;
+      numWrapped = overflow;
+    }
+
+    auto place = [this, numBuckets](PositionT pos, Staged& e,
+                                    PositionT homePos) {
+      buckets.placeAtPos(pos >= numBuckets ? pos - numBuckets : pos,
+                         std::move(e.key),
+                         toStoredHash<StoredHashT>(e.hash),
+                         static_cast<ProbeSeqLenT>(pos - homePos));
+    };
+    // Every region only writes to its own buckets, stopping at the first key
+    // pushed past its end
+    std::vector<SizeT> firstOverflows(numRegions);
+    std::vector<PositionT> overflowCarries(numRegions);
+    runTasks(numRegions, [&](SizeT r) {
+      auto firstPos = regionStart(r), lastPos = regionStart(r + 1);
+      buckets.resetRange(firstPos, lastPos);
+      auto i = regionKeysBegin(r), end = i + numUniques[r];
+      PositionT nextFree = carryIns[r];
+      for (; i < end; ++i) {
+        auto homePos = homeOf(staged[i]);
+        auto pos = std::max(homePos, nextFree);
+        if (pos >= lastPos)
+          break;
+        place(pos, staged[i], homePos);
+        nextFree = pos + 1;
+      }
+      firstOverflows[r] = i;
+      overflowCarries[r] = nextFree;
+    });
+    // Fix-up: overflow chains land in the buckets the next regions left free
+    // before their carry in
+    for (SizeT r = 0; r < numRegions; ++r) {
+      PositionT nextFree = overflowCarries[r];
+      auto end = regionKeysBegin(r) + numUniques[r];
+      for (auto i = firstOverflows[r]; i < end; ++i) {
+        auto homePos = homeOf(staged[i]);
+        auto pos = std::max(homePos, nextFree);
+        place(pos, staged[i], homePos);
+        nextFree = pos + 1;
+      }
+    }
+
+    for (SizeT i = 0; i < numUnique; ++i)
+      statsCounters.onInsert(true);
+    sz = numUnique;
+    return numUnique;
+  }
+
+#if DEBUG
+  void printBucketAtPos(PositionT bucketPos) {
+    auto& key = buckets.keyAtPos(bucketPos);
+    std::cout << "Entry (key = " << key << ", bucket = " << bucketPos
+              << ", psl = " << buckets.pslAtPos(bucketPos) << ", occupied = "
+              << (buckets.isOccupiedAtPos(bucketPos) ? "YES" : "EMPTY")
+              << ", home = " << computeHomePosition(key) << ")\n";
+  }
+#endif
+
+ public:
+  using key_type = Key;
+  using allocator_type = Allocator;
+  using EntryT = typename ContainerT::Entry;
+  using iterator = BucketIterT;
+  // Default construct enabled only if using static alloc
+  // Note that for SFINAE to work, it has to check based on template params
+  // of the function itself, not at the class level. Hence we use _N = N
+  template <size_t _N = N>
+  requires(isStaticAllocSize(_N)) constexpr robinhood_set_fixed() : buckets{} {}
+
+  // Param construct enabled only if using dynamic alloc (uses std::vector)
+  template <size_t _N = N>
+  requires(isDynamicAllocSize(_N)) constexpr explicit robinhood_set_fixed(
+      SizeT fixedCapacity,
+      const Allocator& alloc = Allocator())
+      : buckets(fixedCapacity, alloc) {}
+
+  // Dynamic alloc with bulk construction from [first, last), see assign
+  template <class InputIt, size_t _N = N>
+  requires(isDynamicAllocSize(_N)) robinhood_set_fixed(
+      SizeT fixedCapacity,
+      InputIt first,
+      InputIt last,
+      const Allocator& alloc = Allocator())
+      : buckets(fixedCapacity, alloc) {
+    assign(first, last);
+  }
+
+  // Replaces the content of the set with the keys in [first, last), in
+  // O(n + capacity) time. Duplicate keys are only kept once.
+  // Instead of inserting keys one by one, keys are counting sorted by home
+  // position (then by hash) and laid out in a single sequential pass, which
+  // directly produces a valid robinhood layout. Throws std::runtime_error if
+  // there are more distinct keys than buckets, leaving the set untouched.
+  // Returns the number of distinct keys.
+  template <class InputIt>
+  SizeT assign(InputIt first, InputIt last) {
+    return bulkAssign(first, last, 1);
+  }
+
+  // Same as assign, hashing, sorting and laying out keys on up to numThreads
+  // threads, see bulkAssign. The buckets end up exactly as with assign,
+  // whatever the number of threads. Keys are only hashed in parallel for
+  // random access iterators. Exceptions thrown by the hasher or by key copies
+  // on worker threads terminate the program.
+  template <class InputIt>
+  SizeT assign_parallel(
+      InputIt first,
+      InputIt last,
+      SizeT numThreads = std::thread::hardware_concurrency()) {
+    return bulkAssign(first, last, numThreads);
+  }
+
+  // Copies key, returns true if inserted
+  inline bool insert(Key k) {
+    auto hash = HasherFunc{}(k);
+    return insertFrom(std::move(k), hash, homePositionOf(hash));
+  }
+
+  // Same as insert with the hash of k already known, eg. cached in the
+  // bucket of another table. Pre-condition: hash == hash_function()(k)
+  inline bool insert_with_hash(Key k, size_t hash) {
+    return insertFrom(std::move(k), hash, homePositionOf(hash));
+  }
+
+  // Lookup with the hash of k already known, eg. to probe several tables
+  // with a single hash. Not counted by the StatsPolicy.
+  // Pre-condition: hash == hash_function()(k)
+  inline bool contains_with_hash(const Key& k, size_t hash) const noexcept {
+    return containsFrom(
+        k, toStoredHash<StoredHashT>(hash), homePositionOf(hash));
+  }
+
+  // Find returns an iterator to the Entry
+  inline auto find(const Key& k) noexcept {
+    auto hash = HasherFunc{}(k);
+    return findFrom(k, hash, homePositionOf(hash));
+  }
+
+  // Heterogeneous lookup, eg. find(std::string_view) on a std::string set,
+  // only enabled if both the hasher and the key comparator are transparent
+  template <class K>
+  requires(TransparentKeyTraits<Traits> &&
+           !std::is_same_v<K, Key>) inline auto find(const K& k) noexcept {
+    auto hash = HasherFunc{}(k);
+    return findFrom(k, hash, homePositionOf(hash));
+  }
+
   // Erase returns true if the requested Key is found and deleted
   // Does backshift deletion to avoid tombstones
   inline bool erase(const Key& k) noexcept {
-    // Find the key first
-    auto it = find(k);
-    if (it == end())
+    return erase_with_hash(k, HasherFunc{}(k));
+  }
+
+  // Same as erase with the hash of k already known
+  // Pre-condition: hash == hash_function()(k)
+  inline bool erase_with_hash(const Key& k, size_t hash) noexcept {
+    auto pos = erasePositionFrom(k, hash, homePositionOf(hash));
+    if (pos == capacity())
       return false;
+    return erase(buckets.iteratorAt(pos));
+  }
 
-    PositionT bucketIdxToDelete = std::distance(begin(), it);
+  // Erase the occupied Entry pointed to by it, always returns true
+  // Pre-condition: it points to an occupied bucket of this set
+  inline bool erase(BucketIterT it) noexcept {
+    PositionT bucketIdxToDelete = buckets.positionOf(it);
 #if DEBUG
     std::cout << ">> Erasing ";
-    printEntryAtBucket(*it, bucketIdxToDelete);
+    printBucketAtPos(bucketIdxToDelete);
 #endif
     PositionT currPos = bucketIdxToDelete;
     PositionT nextPos = currPos;
     advancePosition(nextPos);
+    SizeT numShifted = 0;
     // Shift backwards until no more key (wraps around)
-    for (; nextPos != bucketIdxToDelete && buckets[nextPos].isOccupied() &&
-           buckets[nextPos].psl > 0;
+    for (; nextPos != bucketIdxToDelete && buckets.isOccupiedAtPos(nextPos) &&
+           buckets.pslAtPos(nextPos) > 0;
          advancePosition(currPos), advancePosition(nextPos)) {
-      auto& nextElem = buckets[nextPos];
-      auto& currElem = buckets[currPos];
 #if DEBUG
       std::cout << ">> Shifting ";
-      printEntryAtBucket(nextElem, nextPos);
+      printBucketAtPos(nextPos);
 #endif
-      currElem = std::move(nextElem);
-      currElem.psl--;
+      buckets.shiftBackAtPos(nextPos, currPos);
+      ++numShifted;
     }
-    buckets[currPos].setEmpty();
+    buckets.setEmptyAtPos(currPos);
+    statsCounters.onErase(numShifted);
     return --sz, true;
   }
 
+  // Batched operations. Inserts and erases are applied in key order, the
+  // probes of finds are interleaved (see lookupInBatch).
+  // Results are written to out (one iterator per key) or to a bitmap where
+  // bit i is set if the operation succeeded for keys[i], the bitmap must hold
+  // at least (keys.size() + 63) / 64 words.
+
+  void find_batch(std::span<const Key> keys,
+                  std::span<BucketIterT> out) noexcept {
+    lookupInBatch(keys, [&](SizeT i, PositionT pos) {
+      out[i] = buckets.iteratorAt(pos);
+    });
+  }
+
+  // Returns the number of keys found
+  SizeT contains_batch(std::span<const Key> keys,
+                       std::span<uint64_t> bitmap) noexcept {
+    SizeT numFound = 0;
+    resetBitmap(bitmap, keys.size());
+    lookupInBatch(keys, [&](SizeT i, PositionT pos) {
+      if (pos != capacity())
+        setBit(bitmap, i), ++numFound;
+    });
+    return numFound;
+  }
+
+  // Returns the number of keys inserted
+  SizeT insert_batch(std::span<const Key> keys, std::span<uint64_t> bitmap) {
+    SizeT numInserted = 0;
+    resetBitmap(bitmap, keys.size());
+    forEachInBatch<true>(keys, [&](SizeT i, size_t hash, PositionT homePos) {
+      if (insertFrom(keys[i], hash, homePos))
+        setBit(bitmap, i), ++numInserted;
+    });
+    return numInserted;
+  }
+
+  // Returns the number of keys erased
+  SizeT erase_batch(std::span<const Key> keys,
+                    std::span<uint64_t> bitmap) noexcept {
+    SizeT numErased = 0;
+    resetBitmap(bitmap, keys.size());
+    forEachInBatch<true>(keys, [&](SizeT i, size_t hash, PositionT homePos) {
+      if (auto pos = erasePositionFrom(keys[i], hash, homePos);
+          pos != capacity())
+        erase(buckets.iteratorAt(pos)), setBit(bitmap, i), ++numErased;
+    });
+    return numErased;
+  }
+
+  // Bulk erase, in a single pass over the buckets without any backshift.
+  // pred is called once per key, in bucket order. Returns the number of keys
+  // erased.
+  template <class Predicate>
+  SizeT erase_if(Predicate pred) {
+    return compactIf([&](PositionT pos, PositionT) {
+      return !pred(std::as_const(buckets.keyAtPos(pos)));
+    });
+  }
+  template <class Predicate>
+  SizeT retain_if(Predicate pred) {
+    return compactIf([&](PositionT pos, PositionT) {
+      return static_cast<bool>(pred(std::as_const(buckets.keyAtPos(pos))));
+    });
+  }
+
+  // Set algebra, other must use the same hasher (same Traits).
+  // With the same capacity, both bucket arrays are walked by increasing home
+  // position like a merge, so that every probe in the other set lands right
+  // after the previous one and no key is rehashed. Otherwise keys are probed
+  // in batches with prefetching.
+
+  // Keeps the keys also in other, returns the number of keys erased
+  SizeT intersect_with(const robinhood_set_fixed& other) {
+    if (this == &other)
+      return 0;
+    return compactByMembership(other, true);
+  }
+
+  // Erases the keys in other, returns the number of keys erased
+  SizeT difference_with(const robinhood_set_fixed& other) {
+    if (this == &other) {
+      auto numErased = size();
+      clear();
+      return numErased;
+    }
+    return compactByMembership(other, false);
+  }
+
+  // Inserts the keys of other, returns the number of keys inserted.
+  // Throws std::runtime_error, leaving the set untouched, if the union does
+  // not fit.
+  SizeT union_with(const robinhood_set_fixed& other) {
+    if (this == &other)
+      return 0;
+    if (size() + other.size() > capacity()) {
+      SizeT numCommon = 0;
+      forEachOccupiedInBatch<false>(
+          other, *this, [&](PositionT pos, size_t hash, PositionT homePos) {
+            numCommon += containsFrom(other.buckets.keyAtPos(pos),
+                                      toStoredHash<StoredHashT>(hash),
+                                      homePos);
+          });
+      if (size() + other.size() - numCommon > capacity())
+        throw std::runtime_error("Union too large for this robinhood set");
+    }
+    SizeT numInserted = 0;
+    if (other.capacity() == capacity()) {
+      for (PositionT pos = 0; pos < capacity(); ++pos) {
+        if (other.buckets.isEmptyAtPos(pos))
+          continue;
+        numInserted += insertStoredFrom(other.buckets.keyAtPos(pos),
+                                        other.buckets.storedHashAtPos(pos),
+                                        other.homePositionAtPos(pos));
+      }
+    } else {
+      forEachOccupiedInBatch<true>(
+          other, *this, [&](PositionT pos, size_t hash, PositionT homePos) {
+            numInserted +=
+                insertFrom(other.buckets.keyAtPos(pos), hash, homePos);
+          });
+    }
+    return numInserted;
+  }
+
   // Capacity and fullness
   inline constexpr SizeT capacity() const noexcept {
-    return buckets.size();
+    return buckets.capacity();
   }
   inline bool isFull() const noexcept {
     return sz == capacity();
@@ -270,24 +1409,68 @@ requires(isDynamicAllocSize(N) or
 
   // Iters
   auto end() noexcept {
-    return buckets.end();
+    return buckets.iteratorAt(capacity());
   }
 
   void clear() noexcept {
     sz = 0;
-    for (auto& e : buckets)
-      e.reset();
+    buckets.reset();
   }
 
-  // Accessor to raw buffer
-  inline constexpr BucketsT& data() {
-    return buckets;
+  // Empties buckets [first, last) without changing size(), so that a set
+  // allocated with an Allocator leaving buckets uninitialized can be
+  // cleared a slice at a time. Pre-condition: the range holds no key, and
+  // the set is not used before every bucket has been reset
+  void reset_buckets(PositionT first, PositionT last) noexcept {
+    buckets.resetRange(first, last);
+  }
+
+  // Accessor to raw buffer, AoSLayout only
+  template <bool _IsAoS = kIsAoS>
+  requires(_IsAoS) inline constexpr auto& data() {
+    return buckets.entries;
+  }
+  template <bool _IsAoS = kIsAoS>
+  requires(_IsAoS) inline constexpr const auto& data() const {
+    return buckets.entries;
+  }
+
+  // Bytes taken by the buckets, not counting memory owned by the keys
+  inline constexpr SizeT memory_usage() const noexcept {
+    return buckets.memoryUsage();
   }
 
   // Observers
   inline constexpr auto hash_function() noexcept {
     return HasherFunc{};
   }
+
+  // Statistics, only available with a StatsPolicy that keeps counters
+  // The PSL histogram is computed from the buckets, in O(capacity)
+  template <class _StatsPolicy = StatsPolicy>
+  requires(_StatsPolicy::enabled) RobinhoodStats stats() const {
+    RobinhoodStats snapshot = statsCounters.counters;
+    snapshot.size = sz;
+    snapshot.capacity = capacity();
+    SizeT pslSum = 0;
+    for (PositionT pos = 0; pos < capacity(); ++pos) {
+      if (buckets.isEmptyAtPos(pos))
+        continue;
+      auto psl = buckets.pslAtPos(pos);
+      if (psl >= snapshot.pslHistogram.size())
+        snapshot.pslHistogram.resize(psl + 1);
+      ++snapshot.pslHistogram[psl];
+      pslSum += psl;
+      snapshot.maxPsl = std::max<SizeT>(snapshot.maxPsl, psl);
+    }
+    snapshot.meanPsl = sz == 0 ? 0.0 : static_cast<double>(pslSum) / sz;
+    return snapshot;
+  }
+
+  template <class _StatsPolicy = StatsPolicy>
+  requires(_StatsPolicy::enabled) void reset_stats() noexcept {
+    statsCounters.counters = RobinhoodStats{};
+  }
 };
 }  // namespace robinhood
 }  // namespace ykoh
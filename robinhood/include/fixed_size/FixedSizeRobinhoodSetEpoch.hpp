@@ -0,0 +1,263 @@
+#pragma once
+
+#include <CapacityPolicy.hpp>
+#include <FixedSizeRobinhoodSet.hpp>
+#include <KeyTraits.hpp>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace ykoh {
+namespace robinhood {
+
+// Fixed size robinhood set with O(1) clear, meant to be reused as a scratch
+// set with a large capacity and a small fill.
+//
+// Instead of an occupied flag, every bucket is stamped with the epoch it was
+// written in and is only occupied if that is the current epoch, so clear()
+// just starts a new epoch. Live buckets are also tracked in a packed
+// occupancy bitmap (with a stamp per 64-bit word) which begin()/end() walk
+// with countr_zero, skipping empty buckets 64 at a time.
+template <class Key,
+          size_t N = DYNAMIC_SIZE,
+          class Traits = KeyTraits<Key>,
+          class CapacityPolicy = ModuloCapacity>
+requires(isDynamicAllocSize(N) or
+         isStaticAllocSize(N)) class robinhood_set_fixed_epoch {
+  // Typedefs
+  using HasherFunc = typename Traits::Hasher;
+  using KeyEqualCmpFunc = typename Traits::EqualTo;
+  using ProbeSeqLenT = uint32_t;
+  using EpochT = uint32_t;
+  using PositionT = size_t;
+  using SizeT = size_t;
+
+  // Epoch 0 is never current, it marks buckets that were erased
+  static constexpr EpochT kStaleEpoch = 0;
+  static constexpr SizeT kStaticCapacity = CapacityPolicy::roundCapacity(N);
+  static constexpr SizeT kStaticNumWords = (kStaticCapacity + 63) / 64;
+
+  struct Entry {
+    Key key;
+    ProbeSeqLenT psl;
+    EpochT epoch;
+  };
+
+  struct OccupancyWord {
+    uint64_t bits;
+    EpochT epoch;
+  };
+
+  using BucketsT = std::conditional_t<isDynamicAllocSize(N),
+                                      std::vector<Entry>,
+                                      std::array<Entry, kStaticCapacity>>;
+  using WordsT = std::conditional_t<isDynamicAllocSize(N),
+                                    std::vector<OccupancyWord>,
+                                    std::array<OccupancyWord, kStaticNumWords>>;
+
+  // Members
+  SizeT sz{0};
+  EpochT currEpoch{1};
+  BucketsT buckets;
+  WordsT words;
+
+  // Private methods
+  inline constexpr PositionT computeHomePosition(const Key& k) const {
+    return CapacityPolicy::reduce(HasherFunc{}(k), capacity());
+  }
+  inline constexpr void advancePosition(PositionT& pos) const {
+    pos = CapacityPolicy::next(pos, capacity());
+  }
+  inline bool isOccupiedAtPos(PositionT pos) const noexcept {
+    return buckets[pos].epoch == currEpoch;
+  }
+
+  // Occupancy bits of word i, words stamped with an old epoch are empty
+  inline uint64_t liveBits(SizeT i) const noexcept {
+    return words[i].epoch == currEpoch ? words[i].bits : 0;
+  }
+  inline void setLiveBit(PositionT pos) noexcept {
+    auto& w = words[pos / 64];
+    if (w.epoch != currEpoch)
+      w = OccupancyWord{0, currEpoch};
+    w.bits |= uint64_t{1} << (pos % 64);
+  }
+  inline void clearLiveBit(PositionT pos) noexcept {
+    words[pos / 64].bits &= ~(uint64_t{1} << (pos % 64));
+  }
+
+  PositionT findPosition(const Key& k) const noexcept {
+    auto searchPos = computeHomePosition(k);
+    for (ProbeSeqLenT currPsl = 0;
+         currPsl < capacity() && isOccupiedAtPos(searchPos) &&
+         buckets[searchPos].psl >= currPsl;
+         ++currPsl, advancePosition(searchPos)) {
+      if (KeyEqualCmpFunc{}(buckets[searchPos].key, k))
+        return searchPos;
+    }
+    return capacity();
+  }
+
+ public:
+  using EntryT = Entry;
+
+  // Forward iterator over occupied buckets only
+  class LiveIterator {
+    friend class robinhood_set_fixed_epoch;
+    robinhood_set_fixed_epoch* set{nullptr};
+    SizeT wordIdx{0};
+    uint64_t bits{0};  // remaining occupied buckets in words[wordIdx]
+
+    LiveIterator(robinhood_set_fixed_epoch* s, SizeT w, uint64_t b)
+        : set(s), wordIdx(w), bits(b) {
+      skipEmptyWords();
+    }
+    void skipEmptyWords() noexcept {
+      while (bits == 0 && ++wordIdx < set->words.size())
+        bits = set->liveBits(wordIdx);
+      if (bits == 0)
+        wordIdx = set->words.size();
+    }
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Entry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Entry*;
+    using reference = Entry&;
+
+    LiveIterator() = default;
+    reference operator*() const noexcept {
+      return set->buckets[position()];
+    }
+    pointer operator->() const noexcept { return &**this; }
+    LiveIterator& operator++() noexcept {
+      bits &= bits - 1;
+      skipEmptyWords();
+      return *this;
+    }
+    LiveIterator operator++(int) noexcept {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+    bool operator==(const LiveIterator& other) const noexcept {
+      return wordIdx == other.wordIdx && bits == other.bits;
+    }
+    // Bucket position of the current entry
+    PositionT position() const noexcept {
+      return wordIdx * 64 + std::countr_zero(bits);
+    }
+  };
+
+  // Default construct enabled only if using static alloc
+  template <size_t _N = N>
+  requires(isStaticAllocSize(_N)) constexpr robinhood_set_fixed_epoch()
+      : buckets{}, words{} {}
+
+  // Param construct enabled only if using dynamic alloc (uses std::vector)
+  template <size_t _N = N>
+  requires(isDynamicAllocSize(_N)) constexpr explicit robinhood_set_fixed_epoch(
+      SizeT fixedCapacity)
+      : buckets(CapacityPolicy::roundCapacity(fixedCapacity)),
+        words((CapacityPolicy::roundCapacity(fixedCapacity) + 63) / 64) {}
+
+  // Copies key, returns true if inserted
+  bool insert(Key k) {
+    if (isFull())
+      return false;
+
+    Entry incomingEntry{std::move(k), 0, currEpoch};
+    auto insertPos = computeHomePosition(incomingEntry.key);
+    while (isOccupiedAtPos(insertPos)) {
+      auto& existingEntry = buckets[insertPos];
+      if (KeyEqualCmpFunc{}(existingEntry.key, incomingEntry.key))
+        return false;
+      if (existingEntry.psl < incomingEntry.psl)
+        std::swap(existingEntry, incomingEntry);
+      ++incomingEntry.psl;
+      advancePosition(insertPos);
+    }
+    buckets[insertPos] = std::move(incomingEntry);
+    setLiveBit(insertPos);
+    return ++sz, true;
+  }
+
+  // Find returns a LiveIterator to the Entry
+  inline LiveIterator find(const Key& k) noexcept {
+    auto pos = findPosition(k);
+    if (pos == capacity())
+      return end();
+    return LiveIterator(this, pos / 64, liveBits(pos / 64) >> (pos % 64)
+                                            << (pos % 64));
+  }
+
+  inline bool contains(const Key& k) const noexcept {
+    return findPosition(k) != capacity();
+  }
+
+  // Erase returns true if the requested Key is found and deleted
+  // Does backshift deletion to avoid tombstones
+  bool erase(const Key& k) noexcept {
+    auto currPos = findPosition(k);
+    if (currPos == capacity())
+      return false;
+    auto nextPos = currPos;
+    advancePosition(nextPos);
+    for (; isOccupiedAtPos(nextPos) && buckets[nextPos].psl > 0;
+         currPos = nextPos, advancePosition(nextPos)) {
+      buckets[currPos] = std::move(buckets[nextPos]);
+      buckets[currPos].psl--;
+    }
+    buckets[currPos].epoch = kStaleEpoch;
+    clearLiveBit(currPos);
+    return --sz, true;
+  }
+
+  // O(1), except once every 2^32 - 1 calls where stamps are reset
+  void clear() noexcept {
+    sz = 0;
+    if (++currEpoch != kStaleEpoch)
+      return;
+    for (auto& e : buckets)
+      e.epoch = kStaleEpoch;
+    for (auto& w : words)
+      w.epoch = kStaleEpoch;
+    currEpoch = kStaleEpoch + 1;
+  }
+
+  // Iters, only over occupied buckets
+  LiveIterator begin() noexcept {
+    if (words.size() == 0)
+      return end();
+    return LiveIterator(this, 0, liveBits(0));
+  }
+  LiveIterator end() noexcept {
+    LiveIterator it;
+    it.set = this;
+    it.wordIdx = words.size();
+    return it;
+  }
+
+  // Capacity and fullness
+  inline constexpr SizeT capacity() const noexcept {
+    return buckets.size();
+  }
+  inline bool isFull() const noexcept {
+    return sz == capacity();
+  }
+  inline constexpr SizeT size() const noexcept {
+    return sz;
+  }
+
+  // Observers
+  inline constexpr auto hash_function() noexcept {
+    return HasherFunc{};
+  }
+};
+}  // namespace robinhood
+}  // namespace ykoh
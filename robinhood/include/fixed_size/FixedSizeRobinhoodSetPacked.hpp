@@ -0,0 +1,313 @@
+#pragma once
+
+#include <CapacityPolicy.hpp>
+#include <FixedSizeRobinhoodSet.hpp>
+#include <KeyTraits.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Define YKOH_ROBINHOOD_NO_SIMD to force the scalar probe path
+#if !defined(YKOH_ROBINHOOD_NO_SIMD) && defined(__AVX2__)
+#define YKOH_ROBINHOOD_PROBE_AVX2 1
+#include <immintrin.h>
+#elif !defined(YKOH_ROBINHOOD_NO_SIMD) && defined(__SSE2__)
+#define YKOH_ROBINHOOD_PROBE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace ykoh {
+namespace robinhood {
+
+// Fixed size robinhood set with byte-packed metadata
+//
+// Every bucket has a 1 byte PSL (stored as psl + 1, 0 means empty) and a 1
+// byte fingerprint taken from the bits of the hash the CapacityPolicy does
+// not reduce on (see CapacityPolicy::fingerprint), each kept in their
+// own array apart from the keys. find() compares a whole window of buckets
+// at once against the PSLs it expects to see (SSE2: 16, AVX2: 32), stops at
+// the first bucket whose PSL is too small and only compares keys on
+// fingerprint hits. The first kMetaPad metadata bytes are mirrored past the
+// end of the arrays so that windows never need to wrap around.
+//
+// Since PSLs are 8 bits, insert also returns false if it would push any PSL
+// past kMaxPsl, which only happens with a degenerate hash or a nearly full
+// table.
+template <class Key,
+          size_t N = DYNAMIC_SIZE,
+          class Traits = KeyTraits<Key>,
+          class CapacityPolicy = ModuloCapacity>
+requires(isDynamicAllocSize(N) or
+         isStaticAllocSize(N)) class robinhood_set_fixed_packed {
+  // Typedefs
+  using HasherFunc = typename Traits::Hasher;
+  using KeyEqualCmpFunc = typename Traits::EqualTo;
+  using MetaT = uint8_t;
+  using FingerprintT = uint8_t;
+  using MaskT = uint32_t;
+  using PositionT = size_t;
+  using SizeT = size_t;
+
+#if YKOH_ROBINHOOD_PROBE_AVX2
+  static constexpr SizeT kProbeWidth = 32;
+#elif YKOH_ROBINHOOD_PROBE_SSE2
+  static constexpr SizeT kProbeWidth = 16;
+#else
+  static constexpr SizeT kProbeWidth = 8;
+#endif
+  static constexpr SizeT kMetaPad = 32;
+  static constexpr MetaT kEmpty = 0;
+  static constexpr SizeT kMaxMeta = 255;
+  static constexpr SizeT kStaticCapacity = CapacityPolicy::roundCapacity(N);
+
+  using MetaBufT =
+      std::conditional_t<isDynamicAllocSize(N),
+                         std::vector<MetaT>,
+                         std::array<MetaT, kStaticCapacity + kMetaPad>>;
+  using KeysT = std::conditional_t<isDynamicAllocSize(N),
+                                   std::vector<Key>,
+                                   std::array<Key, kStaticCapacity>>;
+
+  // Members
+  SizeT sz{0};
+  MetaBufT psls;
+  MetaBufT fingerprints;
+  KeysT keys;
+
+  // Private methods
+  static inline FingerprintT fingerprintOf(size_t hash) noexcept {
+    return CapacityPolicy::fingerprint(hash);
+  }
+  inline PositionT computeHomePosition(size_t hash) const {
+    return CapacityPolicy::reduce(hash, capacity());
+  }
+  inline void advancePosition(PositionT& pos) const {
+    pos = CapacityPolicy::next(pos, capacity());
+  }
+
+  // Writes metadata of a bucket, keeping the mirrored tail in sync
+  inline void setMetaAt(PositionT pos, MetaT psl, FingerprintT fp) {
+    for (auto p = pos; p < capacity() + kMetaPad; p += capacity()) {
+      psls[p] = psl;
+      fingerprints[p] = fp;
+    }
+  }
+
+  // Probes kProbeWidth buckets starting at pos, where bucket pos + i is
+  // expected to hold meta value dist + i.
+  // Sets bit i of stop if the bucket's PSL is smaller than expected (or
+  // empty), and bit i of match if both PSL and fingerprint are as expected
+  inline void probeWindow(PositionT pos,
+                          SizeT dist,
+                          FingerprintT fp,
+                          MaskT& match,
+                          MaskT& stop) const noexcept {
+#if YKOH_ROBINHOOD_PROBE_AVX2
+    const auto laneOffsets = _mm256_setr_epi8(
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+        20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+    auto stored = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(psls.data() + pos));
+    auto storedFps = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(fingerprints.data() + pos));
+    auto expected = _mm256_add_epi8(
+        _mm256_set1_epi8(static_cast<char>(dist)), laneOffsets);
+    auto geq = _mm256_cmpeq_epi8(_mm256_max_epu8(stored, expected), stored);
+    auto hit = _mm256_and_si256(
+        _mm256_cmpeq_epi8(stored, expected),
+        _mm256_cmpeq_epi8(storedFps, _mm256_set1_epi8(static_cast<char>(fp))));
+    stop = ~static_cast<MaskT>(_mm256_movemask_epi8(geq));
+    match = static_cast<MaskT>(_mm256_movemask_epi8(hit));
+#elif YKOH_ROBINHOOD_PROBE_SSE2
+    const auto laneOffsets =
+        _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    auto stored =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(psls.data() + pos));
+    auto storedFps = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(fingerprints.data() + pos));
+    auto expected =
+        _mm_add_epi8(_mm_set1_epi8(static_cast<char>(dist)), laneOffsets);
+    auto geq = _mm_cmpeq_epi8(_mm_max_epu8(stored, expected), stored);
+    auto hit = _mm_and_si128(
+        _mm_cmpeq_epi8(stored, expected),
+        _mm_cmpeq_epi8(storedFps, _mm_set1_epi8(static_cast<char>(fp))));
+    stop = ~static_cast<MaskT>(_mm_movemask_epi8(geq)) & 0xFFFFu;
+    match = static_cast<MaskT>(_mm_movemask_epi8(hit));
+#else
+    match = stop = 0;
+    for (SizeT i = 0; i < kProbeWidth; ++i) {
+      auto expected = static_cast<MetaT>(dist + i);
+      stop |= static_cast<MaskT>(psls[pos + i] < expected) << i;
+      match |= static_cast<MaskT>(psls[pos + i] == expected &&
+                                  fingerprints[pos + i] == fp)
+               << i;
+    }
+#endif
+  }
+
+  // Returns the bucket holding k, capacity() if not found
+  PositionT findPosition(const Key& k) const noexcept {
+    auto hash = HasherFunc{}(k);
+    auto fp = fingerprintOf(hash);
+    PositionT pos = computeHomePosition(hash);
+    // No stored meta value can be larger than this
+    const SizeT maxDist = std::min(capacity(), kMaxMeta);
+    for (SizeT dist = 1; dist <= maxDist; dist += kProbeWidth) {
+      MaskT match, stop;
+      probeWindow(pos, dist, fp, match, stop);
+      // Lanes past maxDist would have wrapped around the uint8 PSL
+      if (dist + kProbeWidth - 1 > maxDist)
+        stop |= ~MaskT{0} << (maxDist - dist + 1);
+      // Only buckets before the first stop can hold k
+      if (stop != 0)
+        match &= (MaskT{1} << std::countr_zero(stop)) - 1;
+      for (; match != 0; match &= match - 1) {
+        auto candidatePos = pos + std::countr_zero(match);
+        if (candidatePos >= capacity())
+          candidatePos %= capacity();
+        if (KeyEqualCmpFunc{}(keys[candidatePos], k))
+          return candidatePos;
+      }
+      if (stop != 0)
+        break;
+      pos += kProbeWidth;
+      if (pos >= capacity())
+        pos %= capacity();
+    }
+    return capacity();
+  }
+
+ public:
+  using KeyIterT = typename KeysT::iterator;
+  static constexpr SizeT kMaxPsl = kMaxMeta - 1;
+
+  // Default construct enabled only if using static alloc
+  template <size_t _N = N>
+  requires(isStaticAllocSize(_N)) constexpr robinhood_set_fixed_packed()
+      : psls{}, fingerprints{}, keys{} {}
+
+  // Param construct enabled only if using dynamic alloc (uses std::vector)
+  template <size_t _N = N>
+  requires(isDynamicAllocSize(_N)) constexpr explicit robinhood_set_fixed_packed(
+      SizeT fixedCapacity)
+      : psls(CapacityPolicy::roundCapacity(fixedCapacity) + kMetaPad),
+        fingerprints(CapacityPolicy::roundCapacity(fixedCapacity) + kMetaPad),
+        keys(CapacityPolicy::roundCapacity(fixedCapacity)) {}
+
+  // Copies key, returns true if inserted
+  bool insert(Key k) {
+    if (isFull())
+      return false;
+
+    auto hash = HasherFunc{}(k);
+    FingerprintT fp = fingerprintOf(hash);
+    PositionT pos = computeHomePosition(hash);
+    SizeT dist = 1;
+    // Look for k up to the first empty or richer bucket
+    for (; psls[pos] >= dist; ++dist, advancePosition(pos)) {
+      if (psls[pos] == dist && fingerprints[pos] == fp &&
+          KeyEqualCmpFunc{}(keys[pos], k))
+        return false;
+    }
+
+    // Dry run of the displacement chain so that a PSL overflow is detected
+    // before anything is modified
+    {
+      auto carried = dist;
+      for (auto p = pos; psls[p] != kEmpty; advancePosition(p)) {
+        if (carried > kMaxMeta)
+          return false;
+        if (psls[p] < carried)
+          carried = psls[p];
+        ++carried;
+      }
+      if (carried > kMaxMeta)
+        return false;
+    }
+
+    // Robinhood displacement
+    auto carriedMeta = static_cast<MetaT>(dist);
+    for (; psls[pos] != kEmpty; ++carriedMeta, advancePosition(pos)) {
+      if (psls[pos] < carriedMeta) {
+        auto displacedMeta = psls[pos];
+        auto displacedFp = fingerprints[pos];
+        setMetaAt(pos, carriedMeta, fp);
+        std::swap(keys[pos], k);
+        carriedMeta = displacedMeta;
+        fp = displacedFp;
+      }
+    }
+    setMetaAt(pos, carriedMeta, fp);
+    keys[pos] = std::move(k);
+    return ++sz, true;
+  }
+
+  // Find returns an iterator to the key
+  inline auto find(const Key& k) noexcept {
+    return keys.begin() + findPosition(k);
+  }
+
+  inline bool contains(const Key& k) const noexcept {
+    return findPosition(k) != capacity();
+  }
+
+  // Erase returns true if the requested Key is found and deleted
+  // Does backshift deletion to avoid tombstones
+  bool erase(const Key& k) noexcept {
+    auto pos = findPosition(k);
+    if (pos == capacity())
+      return false;
+    auto nextPos = pos;
+    advancePosition(nextPos);
+    for (; psls[nextPos] > 1; pos = nextPos, advancePosition(nextPos)) {
+      setMetaAt(pos, psls[nextPos] - 1, fingerprints[nextPos]);
+      keys[pos] = std::move(keys[nextPos]);
+    }
+    setMetaAt(pos, kEmpty, 0);
+    return --sz, true;
+  }
+
+  // Capacity and fullness
+  inline constexpr SizeT capacity() const noexcept {
+    return keys.size();
+  }
+  inline bool isFull() const noexcept {
+    return sz == capacity();
+  }
+  inline constexpr SizeT size() const noexcept {
+    return sz;
+  }
+
+  // Iters
+  auto end() noexcept {
+    return keys.end();
+  }
+
+  void clear() noexcept {
+    sz = 0;
+    std::fill(psls.begin(), psls.end(), kEmpty);
+  }
+
+  // PSL of the bucket at pos, only meaningful if it is occupied
+  inline SizeT pslAtPos(PositionT pos) const noexcept {
+    return psls[pos] - 1;
+  }
+  inline bool isOccupiedAtPos(PositionT pos) const noexcept {
+    return psls[pos] != kEmpty;
+  }
+  // Fingerprint of the bucket at pos, only meaningful if it is occupied
+  inline FingerprintT fingerprintAtPos(PositionT pos) const noexcept {
+    return fingerprints[pos];
+  }
+
+  // Observers
+  inline constexpr auto hash_function() noexcept {
+    return HasherFunc{};
+  }
+};
+}  // namespace robinhood
+}  // namespace ykoh
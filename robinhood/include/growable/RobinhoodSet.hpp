@@ -0,0 +1,276 @@
+#pragma once
+
+#include <CapacityPolicy.hpp>
+#include <FixedSizeRobinhoodSet.hpp>
+#include <KeyTraits.hpp>
+#include <UninitializedAllocator.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+namespace ykoh {
+namespace robinhood {
+
+// Growable robinhood set built on top of two dynamically sized
+// robinhood_set_fixed tables.
+//
+// Once the active table would exceed the max load factor, a table of twice
+// the capacity becomes the active one and the old table is drained into it a
+// few buckets at a time on every subsequent insert (incremental rehashing),
+// so no single insert pays for a full stop-the-world rehash.
+//
+// The old table is drained from the back of a cluster towards its front,
+// starting just before an empty bucket. Removing the last entry of a cluster
+// never requires a backshift, so probe sequences of the entries that are
+// still waiting to be migrated stay valid and find/erase can keep serving
+// them from the old table until the migration completes. The empty bucket
+// is itself searched a bounded number of buckets per insert.
+//
+// Tables are allocated without zeroing their buckets. The next active table
+// is allocated as the active one nears its threshold, and cleared a stride
+// at a time by the inserts leading up to the growth.
+//
+// With StoredHashKeyTraits<Key>, migrated keys reuse the hash cached in their
+// old bucket, so growing never calls the hasher.
+template <class Key,
+          class Traits = KeyTraits<Key>,
+          class CapacityPolicy = ModuloCapacity>
+class robinhood_set {
+  // Typedefs
+  using TableT = robinhood_set_fixed<Key,
+                                     DYNAMIC_SIZE,
+                                     Traits,
+                                     CapacityPolicy,
+                                     NoStats,
+                                     AoSLayout,
+                                     UninitializedAllocator<Key>>;
+  using HasherFunc = typename Traits::Hasher;
+  using PositionT = size_t;
+  using SizeT = size_t;
+
+  static constexpr SizeT kMinCapacity = 16;
+  // Fewest buckets of the next table cleared per insert
+  static constexpr SizeT kClearStride = 64;
+  // Buckets searched for an empty one per bucket of migrateStep
+  static constexpr SizeT kSeekFactor = 8;
+
+  // Members
+  TableT table{0};      // active table, receives every new insert
+  TableT oldTable{0};   // table being drained, capacity 0 when not rehashing
+  TableT nextTable{0};  // next active table, cleared up to nextCleared
+  PositionT nextCleared{0};
+  float maxLoad{0.875f};
+  SizeT growThreshold{0};
+  SizeT prepareThreshold{0};
+  SizeT migrateStride{0};
+  PositionT migratePos{0};
+  SizeT migrateRemaining{0};
+  bool seekingEmpty{false};
+
+  // Private methods
+  static constexpr SizeT thresholdFor(SizeT cap, float loadFactor) {
+    // Always keep at least one empty bucket, the migration relies on it
+    auto limit = static_cast<SizeT>(static_cast<double>(cap) * loadFactor);
+    return std::min(limit, cap - 1);
+  }
+
+  void updateLoadParams() {
+    growThreshold = thresholdFor(table.capacity(), maxLoad);
+    // Leave enough inserts to clear the next table kClearStride at a time
+    auto clearInserts = table.capacity() * 2 / kClearStride + 1;
+    prepareThreshold = growThreshold - std::min(growThreshold, clearInserts);
+    // Drain old buckets fast enough to finish before the active table
+    // reaches its own threshold: oldCap / stride <= maxLoad * oldCap
+    migrateStride = static_cast<SizeT>(std::ceil(1.0f / maxLoad)) + 1;
+  }
+
+  // Clears the next slice of nextTable, allocating it first if needed.
+  // Slices grow if erases and inserts leave fewer inserts than planned.
+  void prepareStep() {
+    auto nextCapacity = CapacityPolicy::roundCapacity(table.capacity() * 2);
+    if (nextTable.capacity() != nextCapacity) {
+      nextTable = TableT{nextCapacity};
+      nextCleared = 0;
+    }
+    auto insertsLeft = growThreshold - std::min(growThreshold, size()) + 1;
+    auto remaining = nextCapacity - nextCleared;
+    auto stride = std::max(kClearStride,
+                           (remaining + insertsLeft - 1) / insertsLeft);
+    auto last = nextCleared + std::min(stride, remaining);
+    nextTable.reset_buckets(nextCleared, last);
+    nextCleared = last;
+  }
+
+  // Cleared table of newCapacity buckets, nextTable if it was prepared
+  TableT takeClearedTable(SizeT newCapacity) {
+    if (nextTable.capacity() != CapacityPolicy::roundCapacity(newCapacity)) {
+      // Prepared for another capacity, eg. before a reserve
+      nextTable = TableT{0};
+      TableT fresh{newCapacity};
+      fresh.reset_buckets(0, fresh.capacity());
+      return fresh;
+    }
+    nextTable.reset_buckets(nextCleared, nextTable.capacity());
+    nextCleared = 0;
+    return std::exchange(nextTable, TableT{0});
+  }
+
+  void startRehash(SizeT newCapacity) {
+    // Only one migration in flight at any time
+    finishRehash();
+    oldTable = std::move(table);
+    table = takeClearedTable(newCapacity);
+    updateLoadParams();
+
+    // Draining starts right after an empty bucket, searched by migrateStep
+    migratePos = 0;
+    migrateRemaining = oldTable.capacity() - 1;
+    seekingEmpty = true;
+  }
+
+  // Moves up to numBuckets buckets from oldTable into table, once an empty
+  // bucket is found within numBuckets * kSeekFactor buckets
+  void migrateStep(SizeT numBuckets) {
+    auto& oldBuckets = oldTable.data();
+    if (seekingEmpty) {
+      // Everything to the left of an empty bucket is the tail of some
+      // cluster, there is always one
+      for (auto budget = numBuckets * kSeekFactor;
+           budget > 0 && oldBuckets[migratePos].isOccupied();
+           --budget)
+        ++migratePos;
+      if (oldBuckets[migratePos].isOccupied())
+        return;
+      // Draining walks backwards from migratePos
+      seekingEmpty = false;
+    }
+    for (; numBuckets > 0 && migrateRemaining > 0;
+         --numBuckets, --migrateRemaining) {
+      migratePos = (migratePos == 0 ? oldTable.capacity() : migratePos) - 1;
+      auto it = oldBuckets.begin() + migratePos;
+      if (it->isEmpty())
+        continue;
+      // The next bucket is empty (already drained), no backshift happens
+      if constexpr (FullStoredHashTraits<Traits>)
+        table.insert_with_hash(std::move(it->key), it->hash);
+      else
+        table.insert(std::move(it->key));
+      oldTable.erase(it);
+    }
+    if (migrateRemaining == 0)
+      oldTable = TableT{0};
+  }
+
+ public:
+  using key_type = Key;
+
+  explicit robinhood_set(SizeT initialCapacity = kMinCapacity,
+                         float maxLoadFactor = 0.875f)
+      : table{std::max(initialCapacity, kMinCapacity)} {
+    table.reset_buckets(0, table.capacity());
+    max_load_factor(maxLoadFactor);
+  }
+
+  // Copies key, returns true if inserted
+  // Hashes k once, the active table detects duplicates while inserting
+  bool insert(Key k) {
+    auto hash = HasherFunc{}(k);
+    if (isRehashing() && oldTable.contains_with_hash(k, hash))
+      return false;
+    if (size() + 1 > growThreshold) {
+      // The active table is about to be drained, check it before growing
+      if (table.contains_with_hash(k, hash))
+        return false;
+      while (size() + 1 > growThreshold)
+        startRehash(table.capacity() * 2);
+    }
+    if (!table.insert_with_hash(std::move(k), hash))
+      return false;
+    if (isRehashing())
+      migrateStep(migrateStride);
+    if (size() >= prepareThreshold)
+      prepareStep();
+    return true;
+  }
+
+  // Returns a pointer to the stored key, nullptr if not found
+  const Key* find(const Key& k) noexcept {
+    if (auto it = table.find(k); it != table.end())
+      return &it->key;
+    if (isRehashing()) {
+      if (auto it = oldTable.find(k); it != oldTable.end())
+        return &it->key;
+    }
+    return nullptr;
+  }
+
+  bool contains(const Key& k) noexcept {
+    return find(k) != nullptr;
+  }
+
+  // Erase returns true if the requested Key is found and deleted
+  bool erase(const Key& k) noexcept {
+    if (table.erase(k))
+      return true;
+    return isRehashing() && oldTable.erase(k);
+  }
+
+  // Completes any in-flight migration in one go
+  void finishRehash() {
+    if (isRehashing())
+      migrateStep(oldTable.capacity());
+  }
+
+  // Grows so that at least n keys fit without exceeding the max load factor
+  void reserve(SizeT n) {
+    auto cap = table.capacity();
+    while (thresholdFor(cap, maxLoad) < n)
+      cap *= 2;
+    if (cap != table.capacity()) {
+      startRehash(cap);
+      finishRehash();
+    }
+  }
+
+  void clear() noexcept {
+    table.clear();
+    oldTable = TableT{0};
+    migrateRemaining = 0;
+    seekingEmpty = false;
+  }
+
+  // Capacity and load
+  inline SizeT size() const noexcept {
+    return table.size() + oldTable.size();
+  }
+  inline bool empty() const noexcept {
+    return size() == 0;
+  }
+  inline SizeT capacity() const noexcept {
+    return table.capacity();
+  }
+  inline bool isRehashing() const noexcept {
+    return oldTable.capacity() != 0;
+  }
+  inline float load_factor() const noexcept {
+    return static_cast<float>(size()) / static_cast<float>(capacity());
+  }
+  inline float max_load_factor() const noexcept {
+    return maxLoad;
+  }
+  void max_load_factor(float loadFactor) {
+    if (!(loadFactor > 0.0f && loadFactor < 1.0f))
+      throw std::invalid_argument("max_load_factor must be in (0, 1)");
+    maxLoad = loadFactor;
+    updateLoadParams();
+  }
+
+  // Observers
+  inline constexpr auto hash_function() noexcept {
+    return table.hash_function();
+  }
+};
+}  // namespace robinhood
+}  // namespace ykoh
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <IntMurMurHash3.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Define YKOH_ROBINHOOD_NO_CRC32 to force the multiply-mix byte hash even if
+// the CPU has the SSE4.2 CRC32 instruction
+#if !defined(YKOH_ROBINHOOD_NO_CRC32) && defined(__SSE4_2__)
+#define YKOH_ROBINHOOD_HASH_CRC32 1
+#include <nmmintrin.h>
+#endif
+
+// Hashers for non integral keys, used as KeyTraits defaults
+//  - StringHash:  std::string, std::string_view and C strings, transparent
+//  - PointerHash: mixes the address instead of using it as is
+//  - EnumHash:    mixes the underlying value instead of using it as is
+//  - TupleHash:   combines the hashes of the elements of a pair or tuple
+
+namespace fast_hash_detail {
+
+inline uint64_t read64(const uint8_t* p) noexcept {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+inline uint64_t read32(const uint8_t* p) noexcept {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// 64x64 -> 128 bit multiply, folded back to 64 bits
+inline uint64_t mulFold(uint64_t a, uint64_t b) noexcept {
+  __extension__ using uint128_t = unsigned __int128;
+  auto r = static_cast<uint128_t>(a) * b;
+  return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
+
+inline constexpr uint64_t kSecret0 = 0xa0761d6478bd642full;
+inline constexpr uint64_t kSecret1 = 0xe7037ed1a0b428dbull;
+inline constexpr uint64_t kSecret2 = 0x8ebc6af09c88c6e3ull;
+inline constexpr uint64_t kSecret3 = 0x589965cc75374cc3ull;
+
+// Multiply-mix byte hash, consumes 48 bytes per step in 3 independent lanes
+// Adapted from wyhash (public domain):
+// https://github.com/wangyi-fudan/wyhash
+inline uint64_t hashBytesMulMix(const void* data,
+                                size_t len,
+                                uint64_t seed) noexcept {
+  auto p = static_cast<const uint8_t*>(data);
+  seed ^= mulFold(seed ^ kSecret0, kSecret1);
+  uint64_t a, b;
+  if (len <= 16) {
+    if (len >= 4) {
+      auto mid = (len >> 3) << 2;
+      a = (read32(p) << 32) | read32(p + mid);
+      b = (read32(p + len - 4) << 32) | read32(p + len - 4 - mid);
+    } else if (len > 0) {
+      a = (uint64_t{p[0]} << 16) | (uint64_t{p[len >> 1]} << 8) | p[len - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    auto remaining = len;
+    if (remaining > 48) {
+      auto seed1 = seed, seed2 = seed;
+      do {
+        seed = mulFold(read64(p) ^ kSecret1, read64(p + 8) ^ seed);
+        seed1 = mulFold(read64(p + 16) ^ kSecret2, read64(p + 24) ^ seed1);
+        seed2 = mulFold(read64(p + 32) ^ kSecret3, read64(p + 40) ^ seed2);
+        p += 48, remaining -= 48;
+      } while (remaining > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    while (remaining > 16) {
+      seed = mulFold(read64(p) ^ kSecret1, read64(p + 8) ^ seed);
+      p += 16, remaining -= 16;
+    }
+    a = read64(p + remaining - 16);
+    b = read64(p + remaining - 8);
+  }
+  return mulFold(kSecret1 ^ len, mulFold(a ^ kSecret1, b ^ seed));
+}
+
+#if YKOH_ROBINHOOD_HASH_CRC32
+// CRC32 byte hash, consumes 16 bytes per step in 2 independent lanes, the
+// two 32-bit CRCs are then mixed into 64 bits
+inline uint64_t hashBytesCrc32(const void* data,
+                               size_t len,
+                               uint64_t seed) noexcept {
+  auto p = static_cast<const uint8_t*>(data);
+  uint64_t lane0 = static_cast<uint32_t>(seed ^ len);
+  uint64_t lane1 = static_cast<uint32_t>((seed ^ kSecret0) >> 32);
+  auto remaining = len;
+  for (; remaining >= 16; p += 16, remaining -= 16) {
+    lane0 = _mm_crc32_u64(lane0, read64(p));
+    lane1 = _mm_crc32_u64(lane1, read64(p + 8));
+  }
+  if (remaining >= 8) {
+    lane0 = _mm_crc32_u64(lane0, read64(p));
+    p += 8, remaining -= 8;
+  }
+  if (remaining > 0) {
+    uint64_t tail = 0;
+    std::memcpy(&tail, p, remaining);
+    lane1 = _mm_crc32_u64(lane1, tail);
+  }
+  return IntMurMurHash3{}((lane0 << 32) | lane1);
+}
+#endif
+
+inline uint64_t hashBytes(const void* data, size_t len) noexcept {
+#if YKOH_ROBINHOOD_HASH_CRC32
+  return hashBytesCrc32(data, len, kSecret2);
+#else
+  return hashBytesMulMix(data, len, kSecret2);
+#endif
+}
+
+inline uint64_t combine(uint64_t seed, uint64_t h) noexcept {
+  return IntMurMurHash3{}(seed ^ (h + 0x9e3779b97f4a7c15ull + (seed << 6) +
+                                  (seed >> 2)));
+}
+
+}  // namespace fast_hash_detail
+
+struct StringHash {
+  // Enables heterogeneous lookups, eg. find(std::string_view) on a
+  // std::string set
+  using is_transparent = void;
+
+  inline size_t operator()(std::string_view s) const noexcept {
+    return fast_hash_detail::hashBytes(s.data(), s.size());
+  }
+  inline size_t operator()(const std::string& s) const noexcept {
+    return (*this)(std::string_view(s));
+  }
+  inline size_t operator()(const char* s) const noexcept {
+    return (*this)(std::string_view(s));
+  }
+};
+
+struct PointerHash {
+  template <class T>
+  inline size_t operator()(T* p) const noexcept {
+    return IntMurMurHash3{}(reinterpret_cast<uintptr_t>(p));
+  }
+};
+
+struct EnumHash {
+  template <class E>
+  requires(std::is_enum_v<E>) inline size_t operator()(E e) const noexcept {
+    return IntMurMurHash3{}(
+        static_cast<uint64_t>(static_cast<std::underlying_type_t<E>>(e)));
+  }
+};
+
+// Hashers[i] hashes the i-th element
+template <class... Hashers>
+struct TupleHash {
+  template <class Tuple>
+  inline size_t operator()(const Tuple& t) const noexcept {
+    return hashElements(t, std::index_sequence_for<Hashers...>{});
+  }
+
+ private:
+  template <class Tuple, size_t... Is>
+  static inline size_t hashElements(const Tuple& t,
+                                    std::index_sequence<Is...>) noexcept {
+    uint64_t seed = sizeof...(Hashers);
+    ((seed = fast_hash_detail::combine(seed, Hashers{}(std::get<Is>(t)))),
+     ...);
+    return static_cast<size_t>(seed);
+  }
+};
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <CapacityPolicy.hpp>
+#include <KeyTraits.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ykoh {
+namespace robinhood {
+
+// Growable robinhood map with a split memory layout
+//
+//  - meta:   dense array of one byte per bucket, 0 means empty and
+//            (psl + 1) means occupied. Probing only reads this array until a
+//            bucket with the expected psl is reached. A psl that would not
+//            fit grows the table, only a poorly mixed hash gets there.
+//  - keys:   keys, together with the index of their value
+//  - values: values, stored densely and never moved by displacement or
+//            rehashing, buckets only refer to them by index. Erased values
+//            are destroyed and their slots reused, at most 2^32 values are
+//            live or free at once.
+//
+// CapacityPolicy (see CapacityPolicy.hpp) decides how hashes are reduced to
+// home positions.
+// Pointers and references to values stay valid until the next insertion.
+template <class Key,
+          class Value,
+          class Traits = KeyTraits<Key>,
+          class CapacityPolicy = ModuloCapacity>
+class robinhood_map {
+  // Typedefs
+  using HasherFunc = typename Traits::Hasher;
+  using KeyEqualCmpFunc = typename Traits::EqualTo;
+  using MetaT = uint8_t;
+  using IndexT = uint32_t;
+  using PositionT = size_t;
+  using SizeT = size_t;
+
+  static constexpr MetaT kEmpty = 0;
+  // Largest psl + 1 stored in meta
+  static constexpr SizeT kMaxMeta = std::numeric_limits<MetaT>::max();
+  static constexpr SizeT kMinCapacity = 16;
+
+  struct KeySlot {
+    Key key;
+    IndexT valueIdx;
+  };
+
+  // Members
+  SizeT sz{0};
+  float maxLoad{0.875f};
+  SizeT growThreshold{0};
+  std::vector<MetaT> meta;
+  std::vector<KeySlot> keys;
+  std::vector<std::optional<Value>> values;
+  std::vector<IndexT> freeValueSlots;
+
+  // Private methods
+  inline PositionT computeHomePosition(const Key& k) const {
+    return CapacityPolicy::reduce(HasherFunc{}(k), capacity());
+  }
+  inline void advancePosition(PositionT& pos) const {
+    pos = CapacityPolicy::next(pos, capacity());
+  }
+
+  // Returns the bucket holding k, capacity() if not found
+  PositionT findPosition(const Key& k) const {
+    auto pos = computeHomePosition(k);
+    // Expected meta value of k if it were stored at pos
+    for (SizeT dist = 1; meta[pos] >= dist; ++dist, advancePosition(pos)) {
+      if (meta[pos] == dist && KeyEqualCmpFunc{}(keys[pos].key, k))
+        return pos;
+    }
+    return capacity();
+  }
+
+  // Robinhood insertion of a key that is known to be absent
+  void placeFrom(PositionT pos, SizeT dist, KeySlot slot) {
+    for (; dist <= kMaxMeta; ++dist, advancePosition(pos)) {
+      if (meta[pos] == kEmpty) {
+        meta[pos] = static_cast<MetaT>(dist);
+        keys[pos] = std::move(slot);
+        return;
+      }
+      if (meta[pos] < dist) {
+        dist = std::exchange(meta[pos], static_cast<MetaT>(dist));
+        std::swap(keys[pos], slot);
+      }
+    }
+    // Saturated, grow and place the slot in hand again from its home
+    rehash(capacity() * 2);
+    placeFrom(computeHomePosition(slot.key), 1, std::move(slot));
+  }
+
+  // Throws if the index of a new value would not fit in IndexT
+  // The free list always has room for every value, so that freeValue never
+  // allocates
+  template <class... Args>
+  IndexT allocValue(Args&&... args) {
+    if (freeValueSlots.empty()) {
+      if (values.size() > std::numeric_limits<IndexT>::max()) {
+        throw std::length_error(
+            "robinhood_map: too many values for the value index");
+      }
+      if (freeValueSlots.capacity() <= values.size())
+        freeValueSlots.reserve(2 * values.size() + 1);
+      values.emplace_back(std::in_place, std::forward<Args>(args)...);
+      return static_cast<IndexT>(values.size() - 1);
+    }
+    auto idx = freeValueSlots.back();
+    values[idx].emplace(std::forward<Args>(args)...);
+    freeValueSlots.pop_back();
+    return idx;
+  }
+
+  // Destroys the value at idx and recycles its slot
+  void freeValue(IndexT idx) noexcept {
+    values[idx].reset();
+    freeValueSlots.push_back(idx);
+  }
+
+  void rehash(SizeT newCapacity) {
+    newCapacity = CapacityPolicy::roundCapacity(newCapacity);
+    auto oldMeta = std::exchange(meta, std::vector<MetaT>(newCapacity));
+    auto oldKeys = std::exchange(keys, std::vector<KeySlot>(newCapacity));
+    growThreshold = thresholdFor(newCapacity);
+    for (PositionT pos = 0; pos < oldMeta.size(); ++pos) {
+      if (oldMeta[pos] == kEmpty)
+        continue;
+      auto homePos = computeHomePosition(oldKeys[pos].key);
+      placeFrom(homePos, 1, std::move(oldKeys[pos]));
+    }
+  }
+
+  SizeT thresholdFor(SizeT cap) const {
+    auto limit = static_cast<SizeT>(static_cast<double>(cap) * maxLoad);
+    return std::min(limit, cap - 1);
+  }
+
+  // Finds k, or makes room for it and places it with a value built from args
+  template <class K, class... Args>
+  std::pair<Value*, bool> findOrEmplace(K&& k, Args&&... args) {
+    if (sz + 1 > growThreshold) {
+      if (auto* v = find(k))
+        return {v, false};
+      rehash(capacity() * 2);
+    }
+
+    // Fused lookup and insertion point search on the meta array only
+    auto pos = computeHomePosition(k);
+    SizeT dist = 1;
+    for (; meta[pos] >= dist; ++dist, advancePosition(pos)) {
+      if (meta[pos] == dist && KeyEqualCmpFunc{}(keys[pos].key, k))
+        return {&*values[keys[pos].valueIdx], false};
+    }
+    // Either empty or a richer entry: k is absent, insert here
+    auto idx = allocValue(std::forward<Args>(args)...);
+    try {
+      // May grow, give the value back if that throws
+      placeFrom(pos, dist, KeySlot{Key(std::forward<K>(k)), idx});
+    } catch (...) {
+      freeValue(idx);
+      throw;
+    }
+    ++sz;
+    return {&*values[idx], true};
+  }
+
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+
+  explicit robinhood_map(SizeT initialCapacity = kMinCapacity,
+                         float maxLoadFactor = 0.875f)
+      : meta(CapacityPolicy::roundCapacity(
+            std::max(initialCapacity, kMinCapacity))),
+        keys(meta.size()) {
+    max_load_factor(maxLoadFactor);
+  }
+
+  // Returns a pointer to the value mapped to k, nullptr if not found
+  Value* find(const Key& k) noexcept {
+    auto pos = findPosition(k);
+    return pos == capacity() ? nullptr : &*values[keys[pos].valueIdx];
+  }
+  const Value* find(const Key& k) const noexcept {
+    auto pos = findPosition(k);
+    return pos == capacity() ? nullptr : &*values[keys[pos].valueIdx];
+  }
+
+  bool contains(const Key& k) const noexcept {
+    return findPosition(k) != capacity();
+  }
+
+  Value& at(const Key& k) {
+    if (auto* v = find(k))
+      return *v;
+    throw std::out_of_range("robinhood_map::at: key not found");
+  }
+
+  // Default constructs the value if k is absent
+  Value& operator[](const Key& k) {
+    return *findOrEmplace(k).first;
+  }
+
+  // Constructs the value from args only if k is absent
+  // Returns the mapped value and whether an insertion took place
+  template <class... Args>
+  std::pair<Value*, bool> try_emplace(const Key& k, Args&&... args) {
+    return findOrEmplace(k, std::forward<Args>(args)...);
+  }
+
+  // Inserts, or assigns to the existing value
+  // Returns the mapped value and whether an insertion took place
+  template <class V>
+  std::pair<Value*, bool> insert_or_assign(const Key& k, V&& v) {
+    auto res = findOrEmplace(k, std::forward<V>(v));
+    if (!res.second)
+      *res.first = std::forward<V>(v);
+    return res;
+  }
+
+  // Erase returns true if the requested Key is found and deleted
+  // Does backshift deletion on meta and keys, the value is destroyed in place
+  bool erase(const Key& k) {
+    auto pos = findPosition(k);
+    if (pos == capacity())
+      return false;
+
+    auto valueIdx = keys[pos].valueIdx;
+    freeValue(valueIdx);
+
+    auto nextPos = pos;
+    advancePosition(nextPos);
+    for (; meta[nextPos] > 1; pos = nextPos, advancePosition(nextPos)) {
+      meta[pos] = meta[nextPos] - 1;
+      keys[pos] = std::move(keys[nextPos]);
+    }
+    meta[pos] = kEmpty;
+    return --sz, true;
+  }
+
+  // Grows so that at least n keys fit without exceeding the max load factor
+  void reserve(SizeT n) {
+    auto cap = capacity();
+    while (thresholdFor(cap) < n)
+      cap *= 2;
+    if (cap != capacity())
+      rehash(cap);
+    values.reserve(n);
+  }
+
+  void clear() noexcept {
+    sz = 0;
+    std::fill(meta.begin(), meta.end(), kEmpty);
+    values.clear();
+    freeValueSlots.clear();
+  }
+
+  // Capacity and load
+  inline SizeT size() const noexcept {
+    return sz;
+  }
+  inline bool empty() const noexcept {
+    return sz == 0;
+  }
+  inline SizeT capacity() const noexcept {
+    return meta.size();
+  }
+  inline float load_factor() const noexcept {
+    return static_cast<float>(sz) / static_cast<float>(capacity());
+  }
+  inline float max_load_factor() const noexcept {
+    return maxLoad;
+  }
+  void max_load_factor(float loadFactor) {
+    if (!(loadFactor > 0.0f && loadFactor < 1.0f))
+      throw std::invalid_argument("max_load_factor must be in (0, 1)");
+    maxLoad = loadFactor;
+    growThreshold = thresholdFor(capacity());
+  }
+
+  // Observers
+  inline constexpr auto hash_function() noexcept {
+    return HasherFunc{};
+  }
+};
+}  // namespace robinhood
+}  // namespace ykoh
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <CapacityPolicy.hpp>
+#include <FixedSizeRobinhoodSet.hpp>
+#include <IntMurMurHash3.hpp>
+#include <KeyTraits.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ykoh {
+namespace robinhood {
+
+// Snapshots of a robinhood_set_fixed for trivially copyable keys
+//
+// File format (native endianness, checked on load):
+//   SnapshotHeader (padded to a multiple of 64 bytes)
+//   capacity * sizeof(Entry) bytes, the raw bucket array, with padding
+//   bytes and empty buckets zeroed so that a set always gives the same file
+//
+// A snapshot can only be served by a view using the same key type, hasher
+// and capacity policy, which is recorded in the header. Key types, hashers
+// and capacity policies need a stable identifier to be snapshotted:
+// specialize SnapshotKeyId / SnapshotHasherId / SnapshotCapacityPolicyId for
+// custom ones. Arithmetic keys are identified by kind and size.
+
+template <class Key>
+struct SnapshotKeyId;
+template <class Key>
+requires std::is_arithmetic_v<Key> struct SnapshotKeyId<Key> {
+  // 1 unsigned, 2 signed, 3 floating point, 4 bool
+  static constexpr uint64_t kind = std::is_same_v<Key, bool>        ? 4
+                                   : std::is_floating_point_v<Key> ? 3
+                                   : std::is_signed_v<Key>         ? 2
+                                                                   : 1;
+  static constexpr uint64_t value = kind << 8 | sizeof(Key);
+};
+
+template <class Hasher>
+struct SnapshotHasherId;
+template <>
+struct SnapshotHasherId<IntMurMurHash3> {
+  static constexpr uint64_t value = 1;
+};
+
+template <class CapacityPolicy>
+struct SnapshotCapacityPolicyId;
+template <>
+struct SnapshotCapacityPolicyId<ModuloCapacity> {
+  static constexpr uint64_t value = 1;
+};
+template <>
+struct SnapshotCapacityPolicyId<PowerOfTwoCapacity> {
+  static constexpr uint64_t value = 2;
+};
+template <>
+struct SnapshotCapacityPolicyId<FastRangeCapacity> {
+  static constexpr uint64_t value = 3;
+};
+
+struct alignas(64) SnapshotHeader {
+  static constexpr char kMagic[8] = {'R', 'H', 'S', 'N', 'A', 'P', '\0', '\0'};
+  static constexpr uint32_t kFormatVersion = 2;
+  static constexpr uint32_t kEndianTag = 0x01020304;
+
+  char magic[8];
+  uint32_t formatVersion;
+  uint32_t endianTag;
+  uint64_t keySize;
+  uint64_t keyTypeId;
+  uint64_t entrySize;
+  uint64_t capacity;
+  uint64_t size;
+  uint64_t hasherId;
+  uint64_t capacityPolicyId;
+
+  template <class Key, class Traits, class CapacityPolicy, class EntryT>
+  static SnapshotHeader describe(uint64_t capacity, uint64_t size) {
+    // Zeroes the padding too, it is written out
+    SnapshotHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.formatVersion = kFormatVersion;
+    h.endianTag = kEndianTag;
+    h.keySize = sizeof(Key);
+    h.keyTypeId = SnapshotKeyId<Key>::value;
+    h.entrySize = sizeof(EntryT);
+    h.capacity = capacity;
+    h.size = size;
+    h.hasherId = SnapshotHasherId<typename Traits::Hasher>::value;
+    h.capacityPolicyId = SnapshotCapacityPolicyId<CapacityPolicy>::value;
+    return h;
+  }
+
+  // Everything but capacity and size must match
+  bool isCompatibleWith(const SnapshotHeader& other) const noexcept {
+    return std::memcmp(magic, other.magic, sizeof(magic)) == 0 &&
+           formatVersion == other.formatVersion &&
+           endianTag == other.endianTag && keySize == other.keySize &&
+           keyTypeId == other.keyTypeId &&
+           entrySize == other.entrySize && hasherId == other.hasherId &&
+           capacityPolicyId == other.capacityPolicyId;
+  }
+};
+
+// Writes the bucket array of s to path, throws std::runtime_error on failure
+// Only sets with the default AoSLayout can be saved, whatever their allocator
+template <class Key,
+          size_t N,
+          class Traits,
+          class CapacityPolicy,
+          class Stats,
+          class Allocator>
+void save_snapshot(const robinhood_set_fixed<Key,
+                                             N,
+                                             Traits,
+                                             CapacityPolicy,
+                                             Stats,
+                                             AoSLayout,
+                                             Allocator>& s,
+                   const std::string& path) {
+  static_assert(std::is_trivially_copyable_v<Key>,
+                "Snapshots require trivially copyable keys");
+  using EntryT = typename std::remove_cvref_t<decltype(s)>::EntryT;
+  auto header = SnapshotHeader::describe<Key, Traits, CapacityPolicy, EntryT>(
+      s.capacity(), s.size());
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  // Buckets go through zeroed copies, leaving out their padding bytes and
+  // the stale keys of empty buckets
+  constexpr size_t kChunkSize = 1024;
+  std::vector<EntryT> chunk(kChunkSize);
+  auto& buckets = s.data();
+  for (size_t first = 0; first < s.capacity() && out; first += kChunkSize) {
+    auto count = std::min(kChunkSize, s.capacity() - first);
+    std::memset(static_cast<void*>(chunk.data()), 0, count * sizeof(EntryT));
+    for (size_t i = 0; i < count; ++i) {
+      auto& e = buckets[first + i];
+      if (e.isEmpty())
+        continue;
+      chunk[i].key = e.key;
+      chunk[i].psl = e.psl;
+      chunk[i].hash = e.hash;
+      chunk[i].setOccupied();
+    }
+    out.write(reinterpret_cast<const char*>(chunk.data()),
+              static_cast<std::streamsize>(count * sizeof(EntryT)));
+  }
+  out.flush();
+  if (!out)
+    throw std::runtime_error("Failed to write robinhood snapshot: " + path);
+}
+
+// Read-only view over a snapshot file, mapped into memory
+//
+// Nothing is copied nor rehashed on load: lookups probe the mapped bucket
+// array directly and pages are faulted in as they are first touched.
+template <class Key,
+          class Traits = KeyTraits<Key>,
+          class CapacityPolicy = ModuloCapacity>
+class robinhood_set_view {
+  static_assert(std::is_trivially_copyable_v<Key>,
+                "Snapshots require trivially copyable keys");
+
+  // Typedefs
+  using HasherFunc = typename Traits::Hasher;
+  using KeyEqualCmpFunc = typename Traits::EqualTo;
+  using EntryT = typename robinhood_set_fixed<Key,
+                                              DYNAMIC_SIZE,
+                                              Traits,
+                                              CapacityPolicy>::EntryT;
+  using PositionT = size_t;
+  using SizeT = size_t;
+
+  // Members
+  void* mapping{nullptr};
+  SizeT mappingLen{0};
+  const EntryT* buckets{nullptr};
+  SizeT cap{0};
+  SizeT sz{0};
+
+  void unmap() noexcept {
+    if (mapping != nullptr)
+      ::munmap(mapping, mappingLen);
+    mapping = nullptr;
+  }
+
+ public:
+  explicit robinhood_set_view(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("Cannot open robinhood snapshot: " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 ||
+        static_cast<SizeT>(st.st_size) < sizeof(SnapshotHeader)) {
+      ::close(fd);
+      throw std::runtime_error("Truncated robinhood snapshot: " + path);
+    }
+    mappingLen = static_cast<SizeT>(st.st_size);
+    mapping = ::mmap(nullptr, mappingLen, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+      mapping = nullptr;
+      throw std::runtime_error("Cannot map robinhood snapshot: " + path);
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    auto expected =
+        SnapshotHeader::describe<Key, Traits, CapacityPolicy, EntryT>(0, 0);
+    if (!header.isCompatibleWith(expected) || header.capacity == 0 ||
+        mappingLen != sizeof(header) + header.capacity * sizeof(EntryT)) {
+      unmap();
+      throw std::runtime_error("Incompatible robinhood snapshot: " + path);
+    }
+    cap = header.capacity;
+    sz = header.size;
+    buckets = reinterpret_cast<const EntryT*>(
+        static_cast<const char*>(mapping) + sizeof(header));
+  }
+
+  robinhood_set_view(const robinhood_set_view&) = delete;
+  robinhood_set_view& operator=(const robinhood_set_view&) = delete;
+  robinhood_set_view(robinhood_set_view&& other) noexcept
+      : mapping(std::exchange(other.mapping, nullptr)),
+        mappingLen(other.mappingLen),
+        buckets(other.buckets),
+        cap(other.cap),
+        sz(other.sz) {}
+  robinhood_set_view& operator=(robinhood_set_view&& other) noexcept {
+    if (this != &other) {
+      unmap();
+      mapping = std::exchange(other.mapping, nullptr);
+      mappingLen = other.mappingLen;
+      buckets = other.buckets;
+      cap = other.cap;
+      sz = other.sz;
+    }
+    return *this;
+  }
+  ~robinhood_set_view() { unmap(); }
+
+  // Returns a pointer to the mapped key, nullptr if not found
+  const Key* find(const Key& k) const noexcept {
+    PositionT searchPos = CapacityPolicy::reduce(HasherFunc{}(k), cap);
+    for (SizeT currPsl = 0; currPsl < cap && buckets[searchPos].isOccupied() &&
+                            buckets[searchPos].psl >= currPsl;
+         ++currPsl, searchPos = CapacityPolicy::next(searchPos, cap)) {
+      if (KeyEqualCmpFunc{}(buckets[searchPos].key, k))
+        return &buckets[searchPos].key;
+    }
+    return nullptr;
+  }
+
+  bool contains(const Key& k) const noexcept {
+    return find(k) != nullptr;
+  }
+
+  // Asks the kernel to start reading the whole bucket array ahead of time
+  void prefetch() const noexcept {
+    ::madvise(mapping, mappingLen, MADV_WILLNEED);
+  }
+
+  inline SizeT size() const noexcept {
+    return sz;
+  }
+  inline SizeT capacity() const noexcept {
+    return cap;
+  }
+};
+}  // namespace robinhood
+}  // namespace ykoh
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Capacity policies decide how many buckets a table really has and how a
+// hash is mapped onto a home position in [0, capacity)
+//  - roundCapacity(n): actual number of buckets used when asked for n
+//  - reduce(hash, cap): home position of a hash
+//  - next(pos, cap): position after pos, wrapping around
+//  - fingerprint(hash): 8 bits of the hash that reduce() depends on the
+//    least, so keys with nearby homes still get different fingerprints
+
+// Arbitrary capacity, uses a 64-bit integer division for every lookup
+struct ModuloCapacity {
+  static constexpr size_t roundCapacity(size_t n) noexcept { return n; }
+  static constexpr size_t reduce(size_t hash, size_t cap) noexcept {
+    return hash % cap;
+  }
+  static constexpr size_t next(size_t pos, size_t cap) noexcept {
+    return ++pos >= cap ? pos - cap : pos;
+  }
+  static constexpr uint8_t fingerprint(size_t hash) noexcept {
+    return static_cast<uint8_t>(hash >> (sizeof(size_t) * 8 - 8));
+  }
+};
+
+// Capacity rounded up to a power of two, reduction and wrap are a mask
+// Only the low bits of the hash are used
+struct PowerOfTwoCapacity {
+  static constexpr size_t roundCapacity(size_t n) noexcept {
+    return n == 0 ? 0 : std::bit_ceil(n);
+  }
+  static constexpr size_t reduce(size_t hash, size_t cap) noexcept {
+    return hash & (cap - 1);
+  }
+  static constexpr size_t next(size_t pos, size_t cap) noexcept {
+    return (pos + 1) & (cap - 1);
+  }
+  static constexpr uint8_t fingerprint(size_t hash) noexcept {
+    return static_cast<uint8_t>(hash >> (sizeof(size_t) * 8 - 8));
+  }
+};
+
+// Arbitrary capacity, reduction is Lemire's multiply-shift (fastrange)
+// Only the high bits of the hash are used, so the hash must mix well (do not
+// use with identity hashes such as std::hash for integers)
+struct FastRangeCapacity {
+  static constexpr size_t roundCapacity(size_t n) noexcept { return n; }
+  static constexpr size_t reduce(size_t hash, size_t cap) noexcept {
+    static_assert(sizeof(size_t) == sizeof(uint64_t));
+    __extension__ using uint128_t = unsigned __int128;
+    return static_cast<size_t>(
+        (static_cast<uint128_t>(hash) * static_cast<uint128_t>(cap)) >> 64);
+  }
+  static constexpr size_t next(size_t pos, size_t cap) noexcept {
+    return ++pos >= cap ? pos - cap : pos;
+  }
+  // The home comes from the high bits, the fingerprint from the low ones
+  static constexpr uint8_t fingerprint(size_t hash) noexcept {
+    return static_cast<uint8_t>(hash);
+  }
+};
@@ -1,14 +1,88 @@
 #pragma once
 
+#include <FastHash.hpp>
 #include <IntMurMurHash3.hpp>
+#include <cstddef>
 #include <type_traits>
 #include <functional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+template <class KeyType>
+struct KeyTraits;
+
+namespace key_traits_detail {
+template <class KeyType>
+struct DefaultHasher {
+  // use IntMurMurHash3 if is integral, mix enums and pointers as well
+  // instead of using std::hash which is the identity for them
+  using type = std::conditional_t<
+      std::is_integral_v<KeyType>,
+      IntMurMurHash3,
+      std::conditional_t<
+          std::is_enum_v<KeyType>,
+          EnumHash,
+          std::conditional_t<std::is_pointer_v<KeyType>,
+                             PointerHash,
+                             std::hash<KeyType>>>>;
+};
+template <>
+struct DefaultHasher<std::string> {
+  using type = StringHash;
+};
+template <>
+struct DefaultHasher<std::string_view> {
+  using type = StringHash;
+};
+template <class A, class B>
+struct DefaultHasher<std::pair<A, B>> {
+  using type = TupleHash<typename KeyTraits<A>::Hasher,
+                         typename KeyTraits<B>::Hasher>;
+};
+template <class... Ts>
+struct DefaultHasher<std::tuple<Ts...>> {
+  using type = TupleHash<typename KeyTraits<Ts>::Hasher...>;
+};
+}  // namespace key_traits_detail
 
 template <class KeyType>
 struct KeyTraits {
-  // use IntMurMurHash3 if is integral
-  using Hasher = std::conditional_t<std::is_integral<KeyType>::value,
-                                    IntMurMurHash3,
-                                    std::hash<KeyType>>;
-  using EqualTo = std::equal_to<KeyType>;
+  using Hasher = typename key_traits_detail::DefaultHasher<KeyType>::type;
+  // Transparent comparison for keys with a transparent hasher
+  using EqualTo = std::conditional_t<
+      std::is_same_v<Hasher, StringHash>,
+      std::equal_to<>,
+      std::equal_to<KeyType>>;
+};
+
+// Traits allowing lookups with keys of another type than the stored one
+template <class Traits>
+concept TransparentKeyTraits = requires {
+  typename Traits::Hasher::is_transparent;
+  typename Traits::EqualTo::is_transparent;
+};
+
+// Traits caching the hash of every key beside it in the buckets, trading
+// memory for never calling the hasher again once a key is inserted: key
+// comparisons check the cached hashes first and rehashing into a new table
+// reuses them. HashT may be narrower than size_t, the truncated hash then
+// only filters key comparisons and rehashing calls the hasher again.
+template <class KeyType,
+          class HashT = size_t,
+          class BaseTraits = KeyTraits<KeyType>>
+struct StoredHashKeyTraits : BaseTraits {
+  static_assert(std::is_unsigned_v<HashT> && sizeof(HashT) <= sizeof(size_t));
+  using StoredHashT = HashT;
+};
+
+template <class Traits>
+concept StoredHashTraits = requires {
+  typename Traits::StoredHashT;
 };
+
+// The cached hash is the full hash, home positions can be derived from it
+template <class Traits>
+concept FullStoredHashTraits = StoredHashTraits<Traits> &&
+    sizeof(typename Traits::StoredHashT) == sizeof(size_t);
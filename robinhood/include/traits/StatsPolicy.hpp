@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Statistics policies are called from the insert/find/erase hot paths of a
+// robinhood set. NoStats compiles every hook away, CountingStats keeps plain
+// (non atomic) counters.
+
+// Snapshot returned by stats(), counters are cumulative since construction or
+// the last reset_stats()
+struct RobinhoodStats {
+  // Operation counters
+  uint64_t inserts{0};        // successful inserts
+  uint64_t insertProbes{0};   // buckets visited by all insert calls
+  uint64_t insertSwaps{0};    // robinhood displacements
+  uint64_t findHits{0};
+  uint64_t findMisses{0};
+  uint64_t findProbes{0};     // buckets visited by all find calls
+  uint64_t erases{0};         // successful erases
+  uint64_t eraseProbes{0};    // buckets visited by all erase calls
+  uint64_t backshifts{0};     // entries shifted back by all erase calls
+  uint64_t maxBackshift{0};   // longest backshift chain of a single erase
+
+  // Table shape, computed from the buckets when the snapshot is taken
+  size_t size{0};
+  size_t capacity{0};
+  double meanPsl{0};
+  size_t maxPsl{0};
+  std::vector<size_t> pslHistogram;  // pslHistogram[p] = #entries with psl p
+};
+
+struct NoStats {
+  static constexpr bool enabled = false;
+  inline constexpr void onInsertProbe() noexcept {}
+  inline constexpr void onInsertSwap() noexcept {}
+  inline constexpr void onInsert(bool) noexcept {}
+  inline constexpr void onFindProbe() noexcept {}
+  inline constexpr void onFind(bool) noexcept {}
+  inline constexpr void onEraseProbe() noexcept {}
+  inline constexpr void onErase(size_t) noexcept {}
+};
+
+struct CountingStats {
+  static constexpr bool enabled = true;
+  RobinhoodStats counters;
+
+  inline void onInsertProbe() noexcept { ++counters.insertProbes; }
+  inline void onInsertSwap() noexcept { ++counters.insertSwaps; }
+  inline void onInsert(bool inserted) noexcept { counters.inserts += inserted; }
+  inline void onFindProbe() noexcept { ++counters.findProbes; }
+  inline void onFind(bool hit) noexcept {
+    ++(hit ? counters.findHits : counters.findMisses);
+  }
+  inline void onEraseProbe() noexcept { ++counters.eraseProbes; }
+  inline void onErase(size_t backshiftLen) noexcept {
+    ++counters.erases;
+    counters.backshifts += backshiftLen;
+    if (backshiftLen > counters.maxBackshift)
+      counters.maxBackshift = backshiftLen;
+  }
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "SparseTableDetail.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace ykoh {
+namespace sparse_tb {
+
+// O(1) range queries for any associative Func, including non-idempotent
+// ones (sum, xor, products, matrix multiply) where computeOverlappingForRange
+// would count the overlap twice.
+// Level k splits the data in blocks of 2^(k+1) values around the midpoints
+// m = block start + 2^k: cells left of m hold func(data[j], ..., data[m-1])
+// and cells from m on hold func(data[m], ..., data[j]). A range [l, r]
+// crossing a midpoint only at level k = bit_width(l ^ r) - 1 is then the
+// combine of two cells. Level 0 is the data itself.
+// Takes n * bit_width(n - 1) values.
+// Takes in lambda as templated type
+template <typename T, class Func> class DisjointSparseTable {
+  // using defs
+  using data_t = T;
+  using lambda_t = Func;
+
+  std::unique_ptr<data_t[]> tb;
+  size_t sz{0};
+  size_t levels{0};
+
+  const data_t *level(size_t k) const { return tb.get() + k * sz; }
+  data_t *level(size_t k) { return tb.get() + k * sz; }
+
+  // Fills blocks [firstBlock, lastBlock) of level k >= 1
+  void buildBlocks(size_t k, size_t firstBlock, size_t lastBlock) {
+    auto funcInstance = lambda_t{};
+    const data_t *data = level(0);
+    data_t *lvl = level(k);
+    auto half = size_t{1} << k;
+    for (size_t block = firstBlock; block < lastBlock; ++block) {
+      auto start = block * 2 * half;
+      auto mid = std::min(start + half, sz);
+      auto end = std::min(start + 2 * half, sz);
+      // Suffixes ending at mid - 1, right to left
+      lvl[mid - 1] = data[mid - 1];
+      for (auto j = mid - 1; j > start; --j)
+        lvl[j - 1] = funcInstance(data[j - 1], lvl[j]);
+      // Prefixes starting at mid, left to right
+      if (mid < end) {
+        lvl[mid] = data[mid];
+        for (auto j = mid + 1; j < end; ++j)
+          lvl[j] = funcInstance(lvl[j - 1], data[j]);
+      }
+    }
+  }
+
+public:
+  // Default ctr
+  explicit DisjointSparseTable() noexcept {}
+
+  template <typename Iterable>
+  explicit DisjointSparseTable(const Iterable &data, size_t numThreads = 1) {
+    initTable(data, numThreads);
+  }
+
+  // Initialize the table in O(N * logN) time where N = data.size()
+  // Every level is split in one slice of blocks per thread, levels do not
+  // depend on each other so the threads never wait
+  template <typename Iterable>
+  void initTable(const Iterable &data, size_t numThreads = 1) {
+    auto dist = std::distance(data.begin(), data.end());
+    if (dist < 0) {
+      throw std::runtime_error("Invalid input range for this Sparse Table");
+    }
+    sz = static_cast<size_t>(dist);
+    levels = sz <= 1 ? sz : static_cast<size_t>(std::bit_width(sz - 1));
+
+    // Every value is written below, skip zeroing the buffer
+    tb = std::make_unique_for_overwrite<data_t[]>(sz * levels);
+    std::copy(data.begin(), data.end(), tb.get());
+
+    numThreads = std::clamp<size_t>(
+        numThreads, 1, std::max<size_t>(sz / detail::kMinCellsPerThread, 1));
+    auto buildSlice = [this, numThreads](size_t t) {
+      for (size_t k = 1; k < levels; ++k) {
+        auto blockSize = size_t{2} << k;
+        auto numBlocks = (sz + blockSize - 1) / blockSize;
+        buildBlocks(k, numBlocks * t / numThreads,
+                    numBlocks * (t + 1) / numThreads);
+      }
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < numThreads; ++t) {
+      workers.emplace_back(buildSlice, t);
+    }
+    buildSlice(0);
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  size_t size() const noexcept { return sz; }
+  // bit_width(size() - 1) levels, one if size() == 1, none if empty
+  size_t numLevels() const noexcept { return levels; }
+  // Bytes taken by the values of every level
+  size_t memoryUsage() const noexcept {
+    return sz * levels * sizeof(data_t);
+  }
+
+  // O(1): Compute func(left, right) for range [left, right) with one
+  // combine of two cells, and one more with init
+  // Pre-condition: right >= left && left >= 0 && size() >= right
+  data_t computeForRange(size_t left, size_t right, data_t init) const {
+    if (right <= left)
+      return init;
+    auto funcInstance = lambda_t{};
+    auto last = right - 1;
+    if (left == last)
+      return funcInstance(init, level(0)[left]);
+    const data_t *lvl = level(detail::fastLog2Floor(left ^ last));
+    return funcInstance(init, funcInstance(lvl[left], lvl[last]));
+  }
+};
+
+} // namespace sparse_tb
+} // namespace ykoh
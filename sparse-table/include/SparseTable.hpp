@@ -0,0 +1,152 @@
+#pragma once
+
+#include "SparseTableDetail.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ykoh {
+namespace sparse_tb {
+
+// Runtime sized, heap allocated counterpart of SparseTableStatic.
+// Level i only holds the n - 2^i + 1 ranges of length 2^i fully inside the
+// data, and all levels are packed back to back in a single buffer, so the
+// table takes sum(n - 2^i + 1) values instead of K * MAXN.
+// Takes in lambda as templated type
+template <typename T, class Func> class SparseTable {
+  // using defs
+  using data_t = T;
+  using lambda_t = Func;
+
+  std::unique_ptr<data_t[]> tb;
+  // Level i starts at tb[levelOffsets[i]]
+  std::vector<size_t> levelOffsets;
+  size_t sz{0};
+
+  const data_t *level(size_t i) const { return tb.get() + levelOffsets[i]; }
+  data_t *level(size_t i) { return tb.get() + levelOffsets[i]; }
+
+public:
+  // Default ctr
+  explicit SparseTable() noexcept {}
+
+  template <typename Iterable>
+  explicit SparseTable(const Iterable &data, size_t numThreads = 1) {
+    initTable(data, numThreads);
+  }
+
+  // Initialize the sparse table in O(N * logN) time where N = data.size()
+  // Levels are built with SIMD for the ops tags and their std equivalents,
+  // and split across numThreads threads, see detail::buildLevels
+  template <typename Iterable>
+  void initTable(const Iterable &data, size_t numThreads = 1) {
+    auto dist = std::distance(data.begin(), data.end());
+    if (dist < 0) {
+      throw std::runtime_error("Invalid input range for this Sparse Table");
+    }
+    sz = static_cast<size_t>(dist);
+
+    levelOffsets.clear();
+    size_t total = 0;
+    for (size_t len = 1; len <= sz; len <<= 1) {
+      levelOffsets.push_back(total);
+      total += sz - len + 1;
+    }
+    // Every value is written below, skip zeroing the buffer
+    tb = std::make_unique_for_overwrite<data_t[]>(total);
+
+    /*
+        Use DP to initialize the table
+        arr[i][j] =
+            Func(arr[i-1][j], arr[i-1][j+2^(i-1)])
+    */
+    std::copy(data.begin(), data.end(), tb.get());
+    detail::buildLevels<data_t, lambda_t>(
+        sz, numLevels(), [this](size_t i) { return level(i); }, numThreads);
+  }
+
+  size_t size() const noexcept { return sz; }
+  // floor(log2(size())) + 1 levels, none if empty
+  size_t numLevels() const noexcept { return levelOffsets.size(); }
+  size_t levelLength(size_t i) const noexcept {
+    return sz - (size_t{1} << i) + 1;
+  }
+  // Bytes taken by the values of every level
+  size_t memoryUsage() const noexcept {
+    if (levelOffsets.empty())
+      return 0;
+    auto last = numLevels() - 1;
+    return (levelOffsets[last] + levelLength(last)) * sizeof(data_t);
+  }
+
+  // O(log(n)): Compute func(left, right) for range  [left, right)
+  // Pre-condition: right >= left && left >= 0 && size() >= right
+  data_t computeForRange(size_t left, size_t right, data_t init) const {
+    if (right <= left)
+      return init;
+    auto funcInstance = lambda_t{};
+    data_t res = init;
+
+    for (auto i = detail::fastLog2Floor(right - left); i >= 0; --i) {
+      auto currIntervalSize = size_t{1} << i;
+      if (currIntervalSize <= right - left) {
+        res = funcInstance(res, level(i)[left]);
+        left += currIntervalSize;
+      }
+    }
+
+    return res;
+  }
+
+  // O(1): Compute across two overlapping sub-ranges of [left, right), see
+  // SparseTableStatic::computeOverlappingForRange
+  // Pre-condition: right >= left && left >= 0 && size() >= right
+  data_t computeOverlappingForRange(size_t left, size_t right,
+                                    data_t init) const {
+    if (right <= left)
+      return init;
+    auto largestPowFloor = detail::fastLog2Floor(right - left);
+    auto funcInstance = lambda_t{};
+    const data_t *lvl = level(largestPowFloor);
+    data_t ret = funcInstance(init, lvl[left]);
+    return funcInstance(ret, lvl[right - (size_t{1} << largestPowFloor)]);
+  }
+
+  // Batched computeForRange: out[q] is the answer for ranges[q], see
+  // detail::disjointForRanges
+  // Pre-condition: out.size() >= ranges.size() and every range is valid
+  void computeForRanges(std::span<const std::pair<size_t, size_t>> ranges,
+                        std::span<data_t> out, data_t init) const {
+    if (sz == 0) {
+      std::fill_n(out.begin(), ranges.size(), init);
+      return;
+    }
+    detail::disjointForRanges<data_t, lambda_t>(
+        tb.get(), [this](size_t i, size_t j) { return levelOffsets[i] + j; },
+        ranges, out, init);
+  }
+
+  // Batched computeOverlappingForRange: out[q] is the answer for ranges[q],
+  // see detail::overlappingForRanges
+  // Pre-condition: out.size() >= ranges.size() and every range is valid
+  void
+  computeOverlappingForRanges(std::span<const std::pair<size_t, size_t>> ranges,
+                              std::span<data_t> out, data_t init) const {
+    if (sz == 0) {
+      std::fill_n(out.begin(), ranges.size(), init);
+      return;
+    }
+    detail::overlappingForRanges<data_t, lambda_t>(
+        tb.get(), [this](size_t i, size_t j) { return levelOffsets[i] + j; },
+        ranges, out, init);
+  }
+};
+
+} // namespace sparse_tb
+} // namespace ykoh
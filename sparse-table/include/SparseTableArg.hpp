@@ -0,0 +1,136 @@
+#pragma once
+
+#include "SparseTableDetail.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ykoh {
+namespace sparse_tb {
+
+// Argmin / argmax: range queries return the position of the answer along
+// with its value.
+// Levels only store Index positions into a copy of the data instead of
+// values, level 0 is implicit (position j) and level i >= 1 holds the
+// n - 2^i + 1 ranges of length 2^i packed as in SparseTable. With
+// uint32_t positions over 64-bit values that is half the memory of
+// SparseTable, less for larger T, and uint16_t fits tables of up to 2^16
+// values.
+// Func must return one of its arguments (ops::Min, ops::Max or the like),
+// and T must be equality comparable. Ties go to the leftmost position.
+// Takes in lambda as templated type
+template <typename T, class Func, std::unsigned_integral Index = uint32_t>
+class SparseTableArg {
+  // using defs
+  using data_t = T;
+  using lambda_t = Func;
+  using index_t = Index;
+
+  std::unique_ptr<data_t[]> values;
+  std::unique_ptr<index_t[]> tb;
+  // Level i >= 1 starts at tb[levelOffsets[i - 1]]
+  std::vector<size_t> levelOffsets;
+  size_t sz{0};
+
+  // Position of the answer of [j, j + 2^i)
+  size_t argAt(size_t i, size_t j) const {
+    return i == 0 ? j : tb[levelOffsets[i - 1] + j];
+  }
+
+  // a if Func picks its value, so ties go to a, the left one in every call
+  size_t better(size_t a, size_t b) const {
+    auto funcInstance = lambda_t{};
+    return funcInstance(values[a], values[b]) == values[a] ? a : b;
+  }
+
+public:
+  // Default ctr
+  explicit SparseTableArg() noexcept {}
+
+  template <typename Iterable> explicit SparseTableArg(const Iterable &data) {
+    initTable(data);
+  }
+
+  // Initialize the sparse table in O(N * logN) time where N = data.size()
+  // Throws if a position of data does not fit in Index
+  template <typename Iterable> void initTable(const Iterable &data) {
+    auto dist = std::distance(data.begin(), data.end());
+    if (dist < 0) {
+      throw std::runtime_error("Invalid input range for this Sparse Table");
+    }
+    if (static_cast<size_t>(dist) >
+        size_t{std::numeric_limits<index_t>::max()} + 1) {
+      throw std::runtime_error(
+          "Input data size is too large for the Index of this Sparse Table");
+    }
+    sz = static_cast<size_t>(dist);
+
+    values = std::make_unique_for_overwrite<data_t[]>(sz);
+    std::copy(data.begin(), data.end(), values.get());
+
+    levelOffsets.clear();
+    size_t total = 0;
+    for (size_t len = 2; len <= sz; len <<= 1) {
+      levelOffsets.push_back(total);
+      total += sz - len + 1;
+    }
+    // Every position is written below, skip zeroing the buffer
+    tb = std::make_unique_for_overwrite<index_t[]>(total);
+
+    /*
+        Use DP to initialize the table
+        arr[i][j] =
+            better(arr[i-1][j], arr[i-1][j+2^(i-1)])
+    */
+    for (size_t i = 1; i < numLevels(); ++i) {
+      auto half = size_t{1} << (i - 1);
+      index_t *lvl = tb.get() + levelOffsets[i - 1];
+      for (size_t j = 0; j < levelLength(i); ++j) {
+        lvl[j] = static_cast<index_t>(better(argAt(i - 1, j),
+                                             argAt(i - 1, j + half)));
+      }
+    }
+  }
+
+  size_t size() const noexcept { return sz; }
+  // floor(log2(size())) + 1 levels including the implicit level 0, none if
+  // empty
+  size_t numLevels() const noexcept {
+    return sz == 0 ? 0 : levelOffsets.size() + 1;
+  }
+  size_t levelLength(size_t i) const noexcept {
+    return sz - (size_t{1} << i) + 1;
+  }
+  // Bytes taken by the copy of the data and the positions of every level
+  size_t memoryUsage() const noexcept {
+    size_t positions = 0;
+    for (size_t i = 1; i < numLevels(); ++i)
+      positions += levelLength(i);
+    return sz * sizeof(data_t) + positions * sizeof(index_t);
+  }
+
+  // O(1): Position and value of func over [left, right), from two
+  // overlapping sub-ranges, see SparseTableStatic::computeOverlappingForRange
+  // The leftmost position on ties
+  // Pre-condition: right > left && left >= 0 && size() >= right
+  std::pair<size_t, data_t> computeArgForRange(size_t left,
+                                               size_t right) const {
+    auto largestPowFloor = detail::fastLog2Floor(right - left);
+    auto arg = better(
+        argAt(largestPowFloor, left),
+        argAt(largestPowFloor, right - (size_t{1} << largestPowFloor)));
+    return {arg, values[arg]};
+  }
+};
+
+} // namespace sparse_tb
+} // namespace ykoh
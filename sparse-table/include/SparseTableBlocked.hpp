@@ -0,0 +1,148 @@
+#pragma once
+
+#include "SparseTable.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace ykoh {
+namespace sparse_tb {
+
+namespace detail {
+// Values of T in a 64 byte cache line, between 8 and 64
+template <typename T> constexpr size_t cacheLineBlockSize() {
+  return std::clamp<size_t>(64 / sizeof(T), 8, 64);
+}
+
+// Unsigned integer of B bits
+template <size_t B>
+using BlockMask = std::conditional_t<
+    B == 8, uint8_t,
+    std::conditional_t<B == 16, uint16_t,
+                       std::conditional_t<B == 32, uint32_t, uint64_t>>>;
+} // namespace detail
+
+// O(n) memory range min / max, a drop-in for computeOverlappingForRange
+// callers of SparseTableStatic and SparseTable.
+// The data is split in blocks of BlockSize values (a cache line by default).
+// A SparseTable is only built over the summary of every block, and queries
+// inside a block read a bitmask of the min / max stack of its prefix
+// (Fischer-Heun): bit i of masks[j] is set if value i of the block is the
+// answer of [i, j]. Takes n * (sizeof(T) + BlockSize / 8) bytes plus the
+// table over n / BlockSize summaries.
+// Func must return one of its arguments (ops::Min, ops::Max or the like),
+// and T must be equality comparable
+template <typename T, class Func,
+          size_t BlockSize = detail::cacheLineBlockSize<T>()>
+class SparseTableBlocked {
+  static_assert(BlockSize == 8 || BlockSize == 16 || BlockSize == 32 ||
+                BlockSize == 64);
+
+  // using defs
+  using data_t = T;
+  using lambda_t = Func;
+  using mask_t = detail::BlockMask<BlockSize>;
+
+  std::unique_ptr<data_t[]> values;
+  std::unique_ptr<mask_t[]> masks;
+  SparseTable<data_t, lambda_t> summaries;
+  size_t sz{0};
+
+  // Answer of [left, last] where both are in the same block
+  data_t inBlock(size_t left, size_t last) const {
+    auto blockStart = left - left % BlockSize;
+    auto candidates = static_cast<mask_t>(
+        masks[last] & (~mask_t{0} << (left - blockStart)));
+    return values[blockStart + std::countr_zero(candidates)];
+  }
+
+public:
+  // Default ctr
+  explicit SparseTableBlocked() noexcept {}
+
+  template <typename Iterable>
+  explicit SparseTableBlocked(const Iterable &data, size_t numThreads = 1) {
+    initTable(data, numThreads);
+  }
+
+  // Initialize in O(N) time where N = data.size(), numThreads only applies
+  // to the table over the block summaries
+  template <typename Iterable>
+  void initTable(const Iterable &data, size_t numThreads = 1) {
+    auto dist = std::distance(data.begin(), data.end());
+    if (dist < 0) {
+      throw std::runtime_error("Invalid input range for this Sparse Table");
+    }
+    sz = static_cast<size_t>(dist);
+
+    values = std::make_unique_for_overwrite<data_t[]>(sz);
+    masks = std::make_unique_for_overwrite<mask_t[]>(sz);
+    std::copy(data.begin(), data.end(), values.get());
+
+    auto funcInstance = lambda_t{};
+    auto blockSummaries = std::vector<data_t>();
+    blockSummaries.reserve((sz + BlockSize - 1) / BlockSize);
+    for (size_t blockStart = 0; blockStart < sz; blockStart += BlockSize) {
+      auto blockEnd = std::min(blockStart + BlockSize, sz);
+      const data_t *block = values.get() + blockStart;
+      mask_t stack = 0;
+      for (size_t j = 0; j < blockEnd - blockStart; ++j) {
+        // Pop the values no better than block[j], they can no longer be
+        // the answer of a range ending after j
+        while (stack != 0) {
+          auto top = std::bit_width(stack) - 1;
+          if (!(funcInstance(block[top], block[j]) == block[j]))
+            break;
+          stack ^= mask_t{1} << top;
+        }
+        stack |= mask_t{1} << j;
+        masks[blockStart + j] = stack;
+      }
+      // The bottom of the stack is the answer of the whole block
+      blockSummaries.push_back(block[std::countr_zero(stack)]);
+    }
+    summaries.initTable(blockSummaries, numThreads);
+  }
+
+  size_t size() const noexcept { return sz; }
+  // Bytes taken by the values, the masks and the table over the summaries
+  size_t memoryUsage() const noexcept {
+    return sz * (sizeof(data_t) + sizeof(mask_t)) + summaries.memoryUsage();
+  }
+
+  // O(1): Compute func over [left, right), the in-block parts of the range
+  // are read from the masks and the whole blocks from the summaries
+  // Pre-condition: right >= left && left >= 0 && size() >= right
+  data_t computeOverlappingForRange(size_t left, size_t right,
+                                    data_t init) const {
+    if (right <= left)
+      return init;
+    auto funcInstance = lambda_t{};
+    auto last = right - 1;
+    auto leftBlock = left / BlockSize;
+    auto lastBlock = last / BlockSize;
+    if (leftBlock == lastBlock)
+      return funcInstance(init, inBlock(left, last));
+
+    data_t res =
+        funcInstance(init, inBlock(left, leftBlock * BlockSize + BlockSize - 1));
+    res = summaries.computeOverlappingForRange(leftBlock + 1, lastBlock, res);
+    return funcInstance(res, inBlock(lastBlock * BlockSize, last));
+  }
+
+  // Same as computeOverlappingForRange, Func is idempotent
+  // Pre-condition: right >= left && left >= 0 && size() >= right
+  data_t computeForRange(size_t left, size_t right, data_t init) const {
+    return computeOverlappingForRange(left, right, init);
+  }
+};
+
+} // namespace sparse_tb
+} // namespace ykoh
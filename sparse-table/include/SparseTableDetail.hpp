@@ -0,0 +1,304 @@
+#pragma once
+
+#include "SparseTableOps.hpp"
+
+#include <algorithm>
+#include <barrier>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Define YKOH_SPARSE_TB_NO_SIMD to force the scalar build and query loops
+#if !defined(YKOH_SPARSE_TB_NO_SIMD) && defined(__GNUC__)
+#define YKOH_SPARSE_TB_SIMD 1
+#if defined(__AVX2__)
+#define YKOH_SPARSE_TB_GATHER_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+namespace ykoh {
+namespace sparse_tb {
+
+namespace detail {
+constexpr int fastLog2Floor(size_t num) { return std::bit_width(num) - 1; }
+
+// Operator tag computing the same as Func on T lane-wise, void if there is
+// none. Recognizes the ops tags, std::ranges::min / max, std::plus,
+// std::bit_and and std::bit_or
+template <class Func, typename T> struct SimdOpFor {
+  using type = void;
+};
+template <typename T> struct SimdOpFor<ops::Min, T> {
+  using type = ops::Min;
+};
+template <typename T> struct SimdOpFor<ops::Max, T> {
+  using type = ops::Max;
+};
+template <typename T> struct SimdOpFor<ops::Sum, T> {
+  using type = ops::Sum;
+};
+template <typename T> struct SimdOpFor<ops::BitAnd, T> {
+  using type = ops::BitAnd;
+};
+template <typename T> struct SimdOpFor<ops::BitOr, T> {
+  using type = ops::BitOr;
+};
+template <typename T>
+struct SimdOpFor<std::remove_cvref_t<decltype(std::ranges::min)>, T> {
+  using type = ops::Min;
+};
+template <typename T>
+struct SimdOpFor<std::remove_cvref_t<decltype(std::ranges::max)>, T> {
+  using type = ops::Max;
+};
+template <typename U, typename T>
+requires(std::is_void_v<U> || std::is_same_v<U, T>) struct SimdOpFor<
+    std::plus<U>, T> {
+  using type = ops::Sum;
+};
+template <typename U, typename T>
+requires(std::is_void_v<U> || std::is_same_v<U, T>) struct SimdOpFor<
+    std::bit_and<U>, T> {
+  using type = ops::BitAnd;
+};
+template <typename U, typename T>
+requires(std::is_void_v<U> || std::is_same_v<U, T>) struct SimdOpFor<
+    std::bit_or<U>, T> {
+  using type = ops::BitOr;
+};
+
+#if YKOH_SPARSE_TB_SIMD
+#if defined(__AVX512F__)
+inline constexpr size_t kSimdBytes = 64;
+#elif defined(__AVX__)
+inline constexpr size_t kSimdBytes = 32;
+#else
+inline constexpr size_t kSimdBytes = 16;
+#endif
+
+// GCC vector extension type, lowered to the widest enabled instruction set
+template <typename T> struct SimdVec {
+  typedef T type __attribute__((vector_size(kSimdBytes)));
+};
+
+template <typename T>
+inline constexpr bool kIsSimdLane =
+    std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8;
+#endif
+
+// Fills cells [first, last) of a level from the previous level:
+// curr[j] = Func(prev[j], prev[j + half])
+template <typename T, class Func>
+void combineCells(const T *prev, T *curr, size_t half, size_t first,
+                  size_t last) {
+  auto funcInstance = Func{};
+  auto j = first;
+#if YKOH_SPARSE_TB_SIMD
+  using SimdOp = typename SimdOpFor<Func, T>::type;
+  if constexpr (!std::is_void_v<SimdOp> && kIsSimdLane<T>) {
+    using V = typename SimdVec<T>::type;
+    constexpr size_t lanes = sizeof(V) / sizeof(T);
+    for (; j + lanes <= last; j += lanes) {
+      V a, b;
+      std::memcpy(&a, prev + j, sizeof(V));
+      std::memcpy(&b, prev + j + half, sizeof(V));
+      V res = SimdOp{}(a, b);
+      std::memcpy(curr + j, &res, sizeof(V));
+    }
+  }
+#endif
+  for (; j < last; ++j) {
+    curr[j] = funcInstance(prev[j], prev[j + half]);
+  }
+}
+
+// Scalar, single threaded buildLevels, usable in constant evaluation
+template <typename T, class Func, class LevelFn>
+constexpr void buildLevelsConstexpr(size_t sz, size_t numLevels,
+                                    const LevelFn &level) {
+  auto funcInstance = Func{};
+  for (size_t i = 1; i < numLevels; ++i) {
+    auto half = size_t{1} << (i - 1);
+    for (size_t j = 0; j + 2 * half <= sz; ++j) {
+      level(i)[j] = funcInstance(level(i - 1)[j], level(i - 1)[j + half]);
+    }
+  }
+}
+
+// Below this many cells per thread, builds use fewer threads
+inline constexpr size_t kMinCellsPerThread = 1 << 14;
+
+// Fills levels [1, numLevels) of a sparse table over sz values from level 0.
+// level(i) points to the first cell of level i, which has sz - 2^i + 1
+// cells. Every level is split in one slice per thread, the threads are
+// started once for the whole build and wait for each other between levels.
+template <typename T, class Func, class LevelFn>
+void buildLevels(size_t sz, size_t numLevels, const LevelFn &level,
+                 size_t numThreads) {
+  numThreads = std::clamp<size_t>(
+      numThreads, 1, std::max<size_t>(sz / kMinCellsPerThread, 1));
+  auto buildSlices = [&](size_t t, const auto &waitForLevel) {
+    for (size_t i = 1; i < numLevels; ++i) {
+      auto len = sz - (size_t{1} << i) + 1;
+      combineCells<T, Func>(level(i - 1), level(i), size_t{1} << (i - 1),
+                            len * t / numThreads, len * (t + 1) / numThreads);
+      waitForLevel();
+    }
+  };
+  if (numThreads == 1) {
+    buildSlices(0, [] {});
+    return;
+  }
+
+  std::barrier levelDone(static_cast<std::ptrdiff_t>(numThreads));
+  auto waitForLevel = [&levelDone] { levelDone.arrive_and_wait(); };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < numThreads; ++t) {
+    workers.emplace_back([&, t] { buildSlices(t, waitForLevel); });
+  }
+  buildSlices(0, waitForLevel);
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+// Batched queries are answered kQueryBlock at a time: the cells of a block
+// are prefetched while the previous block is combined
+inline constexpr size_t kQueryBlock = 32;
+
+using RangeT = std::pair<size_t, size_t>;
+
+// cells[q] = base[idx[q]] for q < kQueryBlock, with AVX2 gathers for 32 and
+// 64-bit types
+template <typename T>
+inline void loadCells(const T *base, const size_t *idx, T *cells) {
+#if YKOH_SPARSE_TB_GATHER_AVX2
+  if constexpr (std::is_trivially_copyable_v<T> &&
+                (sizeof(T) == 4 || sizeof(T) == 8)) {
+    for (size_t q = 0; q < kQueryBlock; q += 4) {
+      auto vidx =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(idx + q));
+      if constexpr (sizeof(T) == 4) {
+        auto v = _mm256_i64gather_epi32(reinterpret_cast<const int *>(base),
+                                        vidx, 4);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(cells + q), v);
+      } else {
+        auto v = _mm256_i64gather_epi64(
+            reinterpret_cast<const long long *>(base), vidx, 8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(cells + q), v);
+      }
+    }
+    return;
+  }
+#endif
+  for (size_t q = 0; q < kQueryBlock; ++q) {
+    cells[q] = base[idx[q]];
+  }
+}
+
+// Batched O(1) overlapping queries, see computeOverlappingForRange.
+// cellIndex(i, j) is the index of cell j of level i from base
+template <typename T, class Func, class CellIndexFn>
+void overlappingForRanges(const T *base, const CellIndexFn &cellIndex,
+                          std::span<const RangeT> ranges, std::span<T> out,
+                          T init) {
+  auto funcInstance = Func{};
+  // Indices of the left and right cells of two blocks: the one being
+  // prefetched and the one being combined
+  size_t lefts[2][kQueryBlock], rights[2][kQueryBlock];
+  T leftCells[kQueryBlock], rightCells[kQueryBlock];
+
+  // Empty ranges read cell 0 of level 0, their answer is init
+  auto prefetchBlock = [&](size_t first, size_t *leftIdx, size_t *rightIdx) {
+    for (size_t q = 0; q < kQueryBlock; ++q) {
+      size_t i = 0, left = 0, right = 0;
+      if (first + q < ranges.size()) {
+        auto [l, r] = ranges[first + q];
+        if (l < r) {
+          i = static_cast<size_t>(fastLog2Floor(r - l));
+          left = cellIndex(i, l);
+          right = cellIndex(i, r - (size_t{1} << i));
+        }
+      }
+      leftIdx[q] = left;
+      rightIdx[q] = right;
+      __builtin_prefetch(base + left);
+      __builtin_prefetch(base + right);
+    }
+  };
+
+  if (ranges.empty())
+    return;
+  prefetchBlock(0, lefts[0], rights[0]);
+  for (size_t first = 0, curr = 0; first < ranges.size();
+       first += kQueryBlock, curr ^= 1) {
+    if (first + kQueryBlock < ranges.size())
+      prefetchBlock(first + kQueryBlock, lefts[curr ^ 1], rights[curr ^ 1]);
+    loadCells(base, lefts[curr], leftCells);
+    loadCells(base, rights[curr], rightCells);
+    auto count = std::min(kQueryBlock, ranges.size() - first);
+    for (size_t q = 0; q < count; ++q) {
+      auto [l, r] = ranges[first + q];
+      out[first + q] =
+          l < r ? funcInstance(funcInstance(init, leftCells[q]), rightCells[q])
+                : init;
+    }
+  }
+}
+
+// Batched O(log(n)) queries, see computeForRange. The queries of a block
+// take turns, each combining the cell of its highest remaining length bit
+// and prefetching the next one, so a block has up to kQueryBlock loads in
+// flight. Each query still combines its cells left to right
+template <typename T, class Func, class CellIndexFn>
+void disjointForRanges(const T *base, const CellIndexFn &cellIndex,
+                       std::span<const RangeT> ranges, std::span<T> out,
+                       T init) {
+  auto funcInstance = Func{};
+  size_t xs[kQueryBlock], lens[kQueryBlock], cells[kQueryBlock];
+  T res[kQueryBlock];
+  for (size_t first = 0; first < ranges.size(); first += kQueryBlock) {
+    auto count = std::min(kQueryBlock, ranges.size() - first);
+    size_t active = 0;
+    for (size_t q = 0; q < count; ++q) {
+      auto [l, r] = ranges[first + q];
+      xs[q] = l;
+      lens[q] = r > l ? r - l : 0;
+      res[q] = init;
+      if (lens[q]) {
+        cells[q] = cellIndex(fastLog2Floor(lens[q]), l);
+        __builtin_prefetch(base + cells[q]);
+        ++active;
+      }
+    }
+    while (active > 0) {
+      for (size_t q = 0; q < count; ++q) {
+        if (lens[q] == 0)
+          continue;
+        res[q] = funcInstance(res[q], base[cells[q]]);
+        auto bit = std::bit_floor(lens[q]);
+        xs[q] += bit;
+        lens[q] -= bit;
+        if (lens[q]) {
+          cells[q] = cellIndex(fastLog2Floor(lens[q]), xs[q]);
+          __builtin_prefetch(base + cells[q]);
+        } else {
+          --active;
+        }
+      }
+    }
+    std::copy(res, res + count, out.begin() + first);
+  }
+}
+
+} // namespace detail
+
+} // namespace sparse_tb
+} // namespace ykoh
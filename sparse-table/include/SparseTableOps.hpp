@@ -0,0 +1,53 @@
+#pragma once
+
+#include <numeric>
+
+namespace ykoh {
+namespace sparse_tb {
+
+// Operator tags, to use as the Func of the sparse tables. Levels of tables
+// over arithmetic types are built with SIMD for every tag but Gcd, see
+// detail::SimdOpFor. Their operator() also applies lane-wise to vector types
+namespace ops {
+
+struct Min {
+  template <typename V> constexpr V operator()(V a, V b) const {
+    return b < a ? b : a;
+  }
+};
+
+struct Max {
+  template <typename V> constexpr V operator()(V a, V b) const {
+    return a < b ? b : a;
+  }
+};
+
+struct Sum {
+  template <typename V> constexpr V operator()(V a, V b) const {
+    return a + b;
+  }
+};
+
+struct BitAnd {
+  template <typename V> constexpr V operator()(V a, V b) const {
+    return a & b;
+  }
+};
+
+struct BitOr {
+  template <typename V> constexpr V operator()(V a, V b) const {
+    return a | b;
+  }
+};
+
+// Scalar only, the levels are still built on several threads
+struct Gcd {
+  template <typename T> constexpr T operator()(T a, T b) const {
+    return std::gcd(a, b);
+  }
+};
+
+} // namespace ops
+
+} // namespace sparse_tb
+} // namespace ykoh
@@ -1,18 +1,19 @@
 #pragma once
 
+#include "SparseTableDetail.hpp"
+
 #include <algorithm>
 #include <array>
 #include <bit>
 #include <iostream>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 namespace ykoh {
 namespace sparse_tb {
 
-namespace detail {
-int fastLog2Floor(size_t num) { return std::bit_width(num) - 1; }
-} // namespace detail
-
 // Takes in lambda as templated type
 template <typename T, size_t K, size_t MAXN, class Func>
 class SparseTableStatic {
@@ -22,34 +23,52 @@ class SparseTableStatic {
   // using defs
   using data_t = T;
   using lambda_t = Func;
-  using table_t = std::array<std::array<data_t, MAXN>, K>;
+  // Level i starts at tb[i * MAXN], one flat array so that the batched
+  // queries can index every level from a single base pointer
+  using table_t = std::array<data_t, K * MAXN>;
   table_t tb;
 
-  template <typename Iterable> bool validateSize(const Iterable &data) {
+  constexpr data_t *level(size_t i) { return tb.data() + i * MAXN; }
+  constexpr const data_t *level(size_t i) const { return tb.data() + i * MAXN; }
+
+  template <typename Iterable>
+  constexpr bool validateSize(const Iterable &data) {
     auto size = std::distance(data.begin(), data.end());
     return size >= 0 && static_cast<size_t>(size) <= MAXN;
   }
 
 public:
   // Default ctr
-  explicit SparseTableStatic() noexcept {}
+  constexpr explicit SparseTableStatic() noexcept {}
 
   template <typename Iterable>
-  explicit SparseTableStatic(const Iterable &data) {
-    initTable(data);
+  constexpr explicit SparseTableStatic(const Iterable &data,
+                                      size_t numThreads = 1) {
+    initTable(data, numThreads);
   }
 
   // Initialize the sparse table in O(N * logN) time where N = data.size()
-  template <typename Iterable> void initTable(const Iterable &data) {
+  // Levels are built with SIMD for the ops tags and their std equivalents,
+  // and split across numThreads threads, see detail::buildLevels.
+  // Usable in constant evaluation, then every cell is zeroed first and the
+  // levels are built by a plain loop, so constexpr tables live in .rodata
+  template <typename Iterable>
+  constexpr void initTable(const Iterable &data, size_t numThreads = 1) {
     // Need to validate first
     if (!validateSize(data)) {
       throw std::runtime_error(
           "Input data size is too large for this Sparse Table");
     }
 
+    if (std::is_constant_evaluated()) {
+      // Constants can not hold indeterminate values
+      tb.fill(data_t{});
+    }
+
     auto sz = static_cast<size_t>(std::distance(data.begin(), data.end()));
+    if (sz == 0)
+      return;
     auto maxI = static_cast<size_t>(detail::fastLog2Floor(sz));
-    auto funcInstance = lambda_t{};
 
     /*
         Use DP to initialize the table
@@ -59,19 +78,22 @@ public:
 
     // Base case (assumed to be true)
     // arr[0][j] = data[j] for ALL j
-    std::copy(data.begin(), data.end(), tb[0].begin());
-
-    // General case
-    for (size_t i = 1; i <= maxI; ++i) {
-      for (size_t j = 0; j < sz; ++j) {
-        tb[i][j] = funcInstance(tb[i - 1][j], tb[i - 1][j + (1 << (i - 1))]);
-      }
+    std::copy(data.begin(), data.end(), level(0));
+
+    // General case, only the sz - 2^i + 1 ranges fully inside the data
+    auto levelOf = [this](size_t i) { return level(i); };
+    if (std::is_constant_evaluated()) {
+      detail::buildLevelsConstexpr<data_t, lambda_t>(sz, maxI + 1, levelOf);
+    } else {
+      detail::buildLevels<data_t, lambda_t>(sz, maxI + 1, levelOf,
+                                            numThreads);
     }
   }
 
   // O(log(n)): Compute func(left, right) for range  [left, right)
   // Pre-condition: right >= left && left >= 0 && MAXN >= right
-  data_t computeForRange(size_t left, size_t right, data_t init) {
+  constexpr data_t computeForRange(size_t left, size_t right,
+                                   data_t init) const {
     if (right <= left)
       return init;
     auto intervalSize = right - left;
@@ -84,7 +106,7 @@ public:
     for (auto i = largestPow; i >= 0; --i) {
       size_t currIntervalSize = 1 << i;
       if (currIntervalSize <= (y - x)) {
-        res = funcInstance(res, tb[i][x]);
+        res = funcInstance(res, level(i)[x]);
         x += currIntervalSize;
       }
     }
@@ -97,15 +119,37 @@ public:
   // computes func(func(left, left + 2^k), func(right - 2^k, right)) where
   // k = floor(log2(interval_size)) where interval_size = (right-left)
   // Pre-condition: right >= left && left >= 0 && MAXN >= right
-  data_t computeOverlappingForRange(size_t left, size_t right, data_t init) {
+  constexpr data_t computeOverlappingForRange(size_t left, size_t right,
+                                              data_t init) const {
     if (right <= left)
       return init;
     auto largestPowFloor = detail::fastLog2Floor(right - left);
     data_t ret = init;
     auto funcInstance = lambda_t{};
-    ret = funcInstance(ret, tb[largestPowFloor][left]);
-    return funcInstance(ret,
-                        tb[largestPowFloor][right - (1 << largestPowFloor)]);
+    ret = funcInstance(ret, level(largestPowFloor)[left]);
+    return funcInstance(
+        ret, level(largestPowFloor)[right - (1 << largestPowFloor)]);
+  }
+
+  // Batched computeForRange: out[q] is the answer for ranges[q], see
+  // detail::disjointForRanges
+  // Pre-condition: out.size() >= ranges.size() and every range is valid
+  void computeForRanges(std::span<const std::pair<size_t, size_t>> ranges,
+                        std::span<data_t> out, data_t init) const {
+    detail::disjointForRanges<data_t, lambda_t>(
+        tb.data(), [](size_t i, size_t j) { return i * MAXN + j; }, ranges,
+        out, init);
+  }
+
+  // Batched computeOverlappingForRange: out[q] is the answer for ranges[q],
+  // see detail::overlappingForRanges
+  // Pre-condition: out.size() >= ranges.size() and every range is valid
+  void
+  computeOverlappingForRanges(std::span<const std::pair<size_t, size_t>> ranges,
+                              std::span<data_t> out, data_t init) const {
+    detail::overlappingForRanges<data_t, lambda_t>(
+        tb.data(), [](size_t i, size_t j) { return i * MAXN + j; }, ranges,
+        out, init);
   }
 };
 
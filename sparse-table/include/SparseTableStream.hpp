@@ -0,0 +1,142 @@
+#pragma once
+
+#include "SparseTableDetail.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ykoh {
+namespace sparse_tb {
+
+// Append-only sparse table for live streams, samples are added one at a
+// time with push_back and never rebuilt.
+// Cells are organized by right endpoint: cell j of level i holds
+// func(data[j - 2^i + 1], ..., data[j]), so a new sample only fills the
+// O(log(n)) cells ending at it.
+// Unbounded by default, level i then holds the n - 2^i + 1 cells ending at
+// j >= 2^i - 1. With a window W, every level is a ring buffer of W cells,
+// only the last W samples can be queried and the table takes
+// W * bit_width(W) values however many samples are pushed.
+// Indices are the positions of the samples in the stream.
+// Takes in lambda as templated type
+template <typename T, class Func> class SparseTableStream {
+  // using defs
+  using data_t = T;
+  using lambda_t = Func;
+
+  std::vector<std::vector<data_t>> levels;
+  size_t sz{0};
+  // 0 if unbounded
+  size_t win{0};
+
+  // Index in its level of the cell of level i ending at sample j
+  size_t cellIndex(size_t i, size_t j) const {
+    return win == 0 ? j - ((size_t{1} << i) - 1) : j % win;
+  }
+  const data_t &cell(size_t i, size_t j) const {
+    return levels[i][cellIndex(i, j)];
+  }
+
+public:
+  // Default ctr, unbounded
+  explicit SparseTableStream() noexcept {}
+
+  // Keeps the last window samples only
+  explicit SparseTableStream(size_t window) : win(window) {
+    if (window == 0) {
+      throw std::runtime_error("Window of this Sparse Table must not be 0");
+    }
+    levels.resize(static_cast<size_t>(std::bit_width(window)));
+    for (auto &lvl : levels)
+      lvl.resize(window);
+  }
+
+  // O(log(n)) amortized, O(log(W)) with a window: fills the cells of every
+  // level ending at the new sample
+  void push_back(data_t value) {
+    auto funcInstance = lambda_t{};
+    auto j = sz;
+    if (win == 0 && std::has_single_bit(j + 1)) {
+      // First cell of a new level
+      levels.emplace_back();
+    }
+    auto available = win == 0 ? j + 1 : std::min(j + 1, win);
+    auto numLevels = static_cast<size_t>(std::bit_width(available));
+
+    auto set = [&](size_t i, data_t v) {
+      if (win == 0)
+        levels[i].push_back(std::move(v));
+      else
+        levels[i][j % win] = std::move(v);
+    };
+    set(0, std::move(value));
+    for (size_t i = 1; i < numLevels; ++i) {
+      auto half = size_t{1} << (i - 1);
+      set(i, funcInstance(cell(i - 1, j - half), cell(i - 1, j)));
+    }
+    ++sz;
+  }
+
+  // Number of samples pushed so far
+  size_t size() const noexcept { return sz; }
+  // 0 if unbounded
+  size_t window() const noexcept { return win; }
+  // First sample that can still be queried
+  size_t windowStart() const noexcept {
+    return win == 0 || sz <= win ? 0 : sz - win;
+  }
+  // Bytes taken by the values of every level
+  size_t memoryUsage() const noexcept {
+    size_t total = 0;
+    for (auto &lvl : levels)
+      total += lvl.size();
+    return total * sizeof(data_t);
+  }
+
+  // O(log(n)): Compute func(left, right) for range [left, right)
+  // Pre-condition: right >= left && left >= windowStart() && size() >= right
+  data_t computeForRange(size_t left, size_t right, data_t init) const {
+    if (right <= left)
+      return init;
+    auto funcInstance = lambda_t{};
+    data_t res = init;
+
+    for (auto i = detail::fastLog2Floor(right - left); i >= 0; --i) {
+      auto currIntervalSize = size_t{1} << i;
+      if (currIntervalSize <= right - left) {
+        left += currIntervalSize;
+        res = funcInstance(res, cell(i, left - 1));
+      }
+    }
+
+    return res;
+  }
+
+  // O(1): Compute across two overlapping sub-ranges of [left, right), see
+  // SparseTableStatic::computeOverlappingForRange
+  // Pre-condition: right >= left && left >= windowStart() && size() >= right
+  data_t computeOverlappingForRange(size_t left, size_t right,
+                                    data_t init) const {
+    if (right <= left)
+      return init;
+    auto largestPowFloor = detail::fastLog2Floor(right - left);
+    auto funcInstance = lambda_t{};
+    data_t ret = funcInstance(
+        init, cell(largestPowFloor, left + (size_t{1} << largestPowFloor) - 1));
+    return funcInstance(ret, cell(largestPowFloor, right - 1));
+  }
+
+  // O(1): computeOverlappingForRange over the last count samples, the
+  // sliding window min / max
+  // Pre-condition: count <= size() - windowStart()
+  data_t computeOverlappingForLast(size_t count, data_t init) const {
+    return computeOverlappingForRange(sz - count, sz, init);
+  }
+};
+
+} // namespace sparse_tb
+} // namespace ykoh
@@ -0,0 +1,126 @@
+#include <FastHash.hpp>
+#include <FixedSizeRobinhoodSet.hpp>
+#include <KeyTraits.hpp>
+#include <TestUtil.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
+
+using namespace ykoh::test_utils;
+
+static std::mt19937 gen32(0);
+
+enum class Color : uint8_t { Red, Green, Blue };
+
+// KeyTraits picks the fast hashers by default
+static_assert(std::is_same_v<KeyTraits<uint64_t>::Hasher, IntMurMurHash3>);
+static_assert(std::is_same_v<KeyTraits<std::string>::Hasher, StringHash>);
+static_assert(std::is_same_v<KeyTraits<std::string_view>::Hasher, StringHash>);
+static_assert(std::is_same_v<KeyTraits<int*>::Hasher, PointerHash>);
+static_assert(std::is_same_v<KeyTraits<Color>::Hasher, EnumHash>);
+static_assert(std::is_same_v<KeyTraits<std::pair<int, std::string>>::Hasher,
+                             TupleHash<IntMurMurHash3, StringHash>>);
+static_assert(TransparentKeyTraits<KeyTraits<std::string>>);
+static_assert(!TransparentKeyTraits<KeyTraits<uint64_t>>);
+
+std::string randomString(size_t len) {
+  std::string s(len, '\0');
+  for (auto& c : s)
+    c = static_cast<char>(gen32());
+  return s;
+}
+
+void testStringHash() {
+  StringHash h;
+  // Same hash whatever the string type
+  for (size_t len = 0; len < 200; ++len) {
+    auto s = randomString(len);
+    assertEquals(h(s), h(std::string_view(s)));
+  }
+  assertEquals(h("robinhood"), h(std::string("robinhood")));
+
+  // No collisions among distinct strings of every length class, including
+  // strings that only differ in their last byte or by a trailing zero
+  std::unordered_set<std::string> strings;
+  for (size_t len = 0; len < 300; ++len) {
+    for (size_t i = 0; i < 200; ++i)
+      strings.insert(randomString(len));
+  }
+  for (size_t len = 1; len < 100; ++len) {
+    auto s = std::string(len, 'a');
+    strings.insert(s);
+    s.back() = 'b';
+    strings.insert(s);
+    strings.insert(s + '\0');
+  }
+  std::unordered_set<size_t> hashes;
+  for (auto& s : strings)
+    hashes.insert(h(s));
+  assertEquals(strings.size(), hashes.size());
+
+  // Low bits are usable for power of two tables
+  std::vector<size_t> lowBitCounts(256);
+  for (size_t i = 0; i < 256 * 256; ++i)
+    ++lowBitCounts[h("key" + std::to_string(i)) & 255];
+  for (auto count : lowBitCounts)
+    assertEquals(true, count > 128 && count < 384);
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testOtherHashers() {
+  // Pointers and enums are mixed, not the identity
+  int values[4];
+  assertEquals(false, PointerHash{}(&values[0]) ==
+                          reinterpret_cast<uintptr_t>(&values[0]));
+  assertEquals(false, EnumHash{}(Color::Green) == 1ul);
+  assertEquals(false, EnumHash{}(Color::Green) == EnumHash{}(Color::Blue));
+
+  // Tuples depend on every element and on their order
+  using PairHash = KeyTraits<std::pair<int, int>>::Hasher;
+  assertEquals(false,
+               PairHash{}(std::pair{1, 2}) == PairHash{}(std::pair{2, 1}));
+  using TripleHash = KeyTraits<std::tuple<int, std::string, Color>>::Hasher;
+  auto tupleA = std::tuple{1, std::string("a"), Color::Red};
+  auto tupleB = std::tuple{1, std::string("b"), Color::Red};
+  assertEquals(false, TripleHash{}(tupleA) == TripleHash{}(tupleB));
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testHeterogeneousLookup() {
+  ykoh::robinhood::robinhood_set_fixed<std::string> testSet(4096);
+  for (size_t i = 0; i < 3000; ++i)
+    assertEquals(true, testSet.insert("key" + std::to_string(i)));
+  for (size_t i = 0; i < 3000; ++i) {
+    auto s = "key" + std::to_string(i);
+    auto it = testSet.find(std::string_view(s));
+    assertEquals(s, it->key);
+    assertEquals(true, it == testSet.find(s));
+  }
+  assertEquals(true, testSet.find(std::string_view("nope")) == testSet.end());
+  assertEquals(true, testSet.find("key42") != testSet.end());
+
+  // Pair keys work out of the box
+  ykoh::robinhood::robinhood_set_fixed<std::pair<uint32_t, uint32_t>> pairSet(
+      4096);
+  for (uint32_t i = 0; i < 3000; ++i)
+    assertEquals(true, pairSet.insert({i, i * 7}));
+  for (uint32_t i = 0; i < 3000; ++i)
+    assertEquals(true, pairSet.find({i, i * 7}) != pairSet.end());
+  assertEquals(true, pairSet.find({1, 1}) == pairSet.end());
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testStringHash();
+  testOtherHashers();
+  testHeterogeneousLookup();
+  return 0;
+}
@@ -0,0 +1,221 @@
+#include <RobinhoodMap.hpp>
+#include <TestUtil.hpp>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+using namespace ykoh::test_utils;
+
+static std::mt19937 gen32(0);
+
+// Large value to make sure values are never dragged around by displacement
+struct BigValue {
+  std::array<uint64_t, 16> payload{};
+  uint64_t id{0};
+  BigValue() = default;
+  explicit BigValue(uint64_t i) : id(i) { payload.fill(i); }
+};
+
+// No default constructor, only try_emplace and erase can be used
+struct NoDefaultValue {
+  uint64_t id;
+  explicit NoDefaultValue(uint64_t i) : id(i) {}
+};
+
+// Poorly mixed hash: with a power of two capacity below 2^12 every key has
+// the same home, so probe sequences would overflow the meta bytes
+struct ShiftedHash {
+  size_t operator()(uint32_t k) const noexcept {
+    return static_cast<size_t>(k) << 12;
+  }
+};
+struct ShiftedTraits {
+  using Hasher = ShiftedHash;
+  using EqualTo = std::equal_to<uint32_t>;
+};
+
+// Key whose copy throws on demand, moves never throw
+struct ThrowingKey {
+  static inline bool throwOnCopy = false;
+  uint32_t k{0};
+  ThrowingKey() = default;
+  explicit ThrowingKey(uint32_t i) : k(i) {}
+  ThrowingKey(const ThrowingKey& other) : k(other.k) {
+    if (throwOnCopy)
+      throw std::runtime_error("copy");
+  }
+  ThrowingKey(ThrowingKey&&) noexcept = default;
+  ThrowingKey& operator=(const ThrowingKey&) = default;
+  ThrowingKey& operator=(ThrowingKey&&) noexcept = default;
+  bool operator==(const ThrowingKey& other) const { return k == other.k; }
+};
+struct ThrowingKeyTraits {
+  struct Hasher {
+    size_t operator()(const ThrowingKey& key) const noexcept {
+      return IntMurMurHash3{}(key.k);
+    }
+  };
+  using EqualTo = std::equal_to<ThrowingKey>;
+};
+
+// Counts the live values
+struct CountedValue {
+  static inline size_t numLive = 0;
+  CountedValue() { ++numLive; }
+  CountedValue(const CountedValue&) { ++numLive; }
+  CountedValue(CountedValue&&) noexcept { ++numLive; }
+  CountedValue& operator=(const CountedValue&) = default;
+  CountedValue& operator=(CountedValue&&) noexcept = default;
+  ~CountedValue() { --numLive; }
+};
+
+template <class KeyT, class CapacityPolicy = ModuloCapacity>
+void testMap(size_t numKeys) {
+  ykoh::robinhood::robinhood_map<KeyT, BigValue, KeyTraits<KeyT>,
+                                 CapacityPolicy>
+      testMap;
+  std::unordered_map<KeyT, uint64_t> gold;
+
+  // try_emplace only inserts once
+  while (gold.size() != numKeys) {
+    auto key = static_cast<KeyT>(gen32());
+    auto id = static_cast<uint64_t>(gen32());
+    auto [v, inserted] = testMap.try_emplace(key, id);
+    assertEquals(gold.emplace(key, id).second, inserted);
+    assertEquals(gold[key], v->id);
+  }
+  assertEquals(gold.size(), testMap.size());
+  for (auto& [k, id] : gold) {
+    assertEquals(true, testMap.contains(k));
+    assertEquals(id, testMap.find(k)->id);
+    assertEquals(id, testMap.find(k)->payload.back());
+  }
+
+  // insert_or_assign overwrites existing values
+  for (auto& [k, id] : gold) {
+    id += 1;
+    auto [v, inserted] = testMap.insert_or_assign(k, BigValue(id));
+    assertEquals(false, inserted);
+    assertEquals(id, v->id);
+  }
+  for (auto& [k, id] : gold)
+    assertEquals(id, testMap.at(k).id);
+
+  // Erase half, then re-insert through operator[] to reuse value slots
+  std::vector<KeyT> deleted;
+  for (auto it = gold.begin(); deleted.size() != numKeys / 2;) {
+    deleted.push_back(it->first);
+    assertEquals(true, testMap.erase(it->first));
+    it = gold.erase(it);
+  }
+  for (auto& k : deleted) {
+    assertEquals(false, testMap.contains(k));
+    assertEquals(false, testMap.erase(k));
+  }
+  for (auto& [k, id] : gold)
+    assertEquals(id, testMap.find(k)->id);
+  for (auto& k : deleted) {
+    assertEquals(0ul, testMap[k].id);
+    testMap[k].id = 7;
+  }
+  for (auto& k : deleted)
+    assertEquals(7ul, testMap.at(k).id);
+  assertEquals(gold.size() + deleted.size(), testMap.size());
+
+  testMap.clear();
+  assertEquals(0ul, testMap.size());
+  assertEquals(true, testMap.find(deleted.front()) == nullptr);
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testStringKeys() {
+  ykoh::robinhood::robinhood_map<std::string, std::string> testMap;
+  for (int i = 0; i < 5000; ++i)
+    testMap["key" + std::to_string(i)] = std::to_string(i);
+  for (int i = 0; i < 5000; ++i)
+    assertEquals(std::to_string(i), testMap.at("key" + std::to_string(i)));
+  assertEquals(5000ul, testMap.size());
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testNoDefaultValue() {
+  ykoh::robinhood::robinhood_map<uint32_t, NoDefaultValue> testMap;
+  for (uint32_t i = 0; i < 1000; ++i)
+    assertEquals(true, testMap.try_emplace(i, i).second);
+  for (uint32_t i = 0; i < 1000; i += 2)
+    assertEquals(true, testMap.erase(i));
+  // Erased slots are reused without ever default constructing a value
+  for (uint32_t i = 0; i < 1000; i += 2)
+    assertEquals(true, testMap.try_emplace(i, i + 1).second);
+  for (uint32_t i = 0; i < 1000; ++i)
+    assertEquals(uint64_t{i % 2 == 0 ? i + 1 : i}, testMap.at(i).id);
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testSaturatedMeta() {
+  ykoh::robinhood::robinhood_map<uint32_t, uint32_t, ShiftedTraits,
+                                 PowerOfTwoCapacity>
+      testMap;
+  for (uint32_t i = 0; i < 1000; ++i)
+    testMap[i] = i;
+  // Long probe sequences grew the table instead of wrapping the meta bytes
+  assertEquals(true, testMap.capacity() > 2048);
+  assertEquals(1000ul, testMap.size());
+  for (uint32_t i = 0; i < 1000; ++i)
+    assertEquals(i, testMap.at(i));
+  for (uint32_t i = 0; i < 1000; i += 2)
+    assertEquals(true, testMap.erase(i));
+  for (uint32_t i = 0; i < 1000; ++i)
+    assertEquals(i % 2 == 1, testMap.contains(i));
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testFailedInsert() {
+  {
+    ykoh::robinhood::robinhood_map<ThrowingKey, CountedValue,
+                                   ThrowingKeyTraits>
+        testMap;
+    for (uint32_t i = 0; i < 100; ++i)
+      testMap.try_emplace(ThrowingKey(i));
+    assertEquals(100ul, CountedValue::numLive);
+
+    // The value built before placing the key is destroyed again
+    ThrowingKey::throwOnCopy = true;
+    bool threw = false;
+    try {
+      testMap.try_emplace(ThrowingKey(1000));
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    ThrowingKey::throwOnCopy = false;
+    assertEquals(true, threw);
+    assertEquals(100ul, testMap.size());
+    assertEquals(100ul, CountedValue::numLive);
+    assertEquals(false, testMap.contains(ThrowingKey(1000)));
+
+    // Its slot is reused
+    testMap.try_emplace(ThrowingKey(1000));
+    assertEquals(101ul, CountedValue::numLive);
+    assertEquals(true, testMap.contains(ThrowingKey(1000)));
+  }
+  assertEquals(0ul, CountedValue::numLive);
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testMap<uint32_t>(50000);
+  testMap<uint64_t>(50000);
+  testMap<int32_t>(20000);
+  testMap<uint64_t, PowerOfTwoCapacity>(50000);
+  testMap<uint32_t, FastRangeCapacity>(50000);
+  testStringKeys();
+  testNoDefaultValue();
+  testSaturatedMeta();
+  testFailedInsert();
+  return 0;
+}
@@ -0,0 +1,184 @@
+#include <FixedSizeRobinhoodSet.hpp>
+#include <KeyTraits.hpp>
+#include <StatsPolicy.hpp>
+#include <TestUtil.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+using namespace ykoh::test_utils;
+namespace rh = ykoh::robinhood;
+
+static std::mt19937 gen32(0);
+
+template <class KeyT,
+          class Layout = rh::AoSLayout,
+          class Traits = KeyTraits<KeyT>,
+          class CapacityPolicy = ModuloCapacity>
+using SetT = rh::robinhood_set_fixed<KeyT,
+                                     0,
+                                     Traits,
+                                     CapacityPolicy,
+                                     CountingStats,
+                                     Layout>;
+
+template <class KeyT>
+KeyT randomKey(size_t range) {
+  if constexpr (std::is_same_v<KeyT, std::string>)
+    return "key" + std::to_string(gen32() % range);
+  else
+    return static_cast<KeyT>(gen32() % range);
+}
+
+template <class Set, class KeyT>
+std::unordered_set<KeyT> fillRandom(Set& testSet,
+                                    size_t numKeys,
+                                    size_t range) {
+  std::unordered_set<KeyT> s;
+  while (s.size() != numKeys) {
+    auto k = randomKey<KeyT>(range);
+    assertEquals(s.insert(k).second, testSet.insert(k));
+  }
+  return s;
+}
+
+// Holds exactly the keys of s, laid out as if they were inserted one by one
+template <class Set, class KeyT>
+void assertSameKeys(Set& testSet, const std::unordered_set<KeyT>& s) {
+  assertEquals(s.size(), testSet.size());
+  for (auto& k : s)
+    assertEquals(k, testSet.find(k)->key);
+  Set rebuilt = testSet;
+  rebuilt.clear();
+  for (auto& k : s)
+    rebuilt.insert(k);
+  assertEquals(true,
+               testSet.stats().pslHistogram == rebuilt.stats().pslHistogram);
+}
+
+template <class KeyT, class Layout, class Traits, class CapacityPolicy>
+void testAlgebra(size_t capA, size_t capB, size_t numA, size_t numB) {
+  using Set = SetT<KeyT, Layout, Traits, CapacityPolicy>;
+  auto range = std::max(numA, numB) * 3 / 2;
+  Set a(capA), b(capB);
+  auto sa = fillRandom<Set, KeyT>(a, numA, range);
+  auto sb = fillRandom<Set, KeyT>(b, numB, range);
+
+  std::unordered_set<KeyT> expectedInter, expectedDiff, expectedUnion = sa;
+  for (auto& k : sa)
+    (sb.count(k) ? expectedInter : expectedDiff).insert(k);
+  expectedUnion.insert(sb.begin(), sb.end());
+
+  Set inter = a;
+  assertEquals(sa.size() - expectedInter.size(), inter.intersect_with(b));
+  assertSameKeys(inter, expectedInter);
+
+  Set diff = a;
+  assertEquals(sa.size() - expectedDiff.size(), diff.difference_with(b));
+  assertSameKeys(diff, expectedDiff);
+
+  if (expectedUnion.size() <= a.capacity()) {
+    Set uni = a;
+    assertEquals(expectedUnion.size() - sa.size(), uni.union_with(b));
+    assertSameKeys(uni, expectedUnion);
+  } else {
+    Set uni = a;
+    bool threw = false;
+    try {
+      uni.union_with(b);
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assertEquals(true, threw);
+    assertSameKeys(uni, sa);
+  }
+
+  // Self
+  Set self = a;
+  assertEquals(0ul, self.intersect_with(self));
+  assertEquals(0ul, self.union_with(self));
+  assertSameKeys(self, sa);
+  assertEquals(sa.size(), self.difference_with(self));
+  assertEquals(0ul, self.size());
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+template <class KeyT, class Layout, class Traits = KeyTraits<KeyT>>
+void testEraseIf(size_t capacity, size_t numKeys) {
+  using Set = SetT<KeyT, Layout, Traits>;
+  for (size_t round = 0; round < 10; ++round) {
+    Set testSet(capacity);
+    auto s = fillRandom<Set, KeyT>(testSet, numKeys, numKeys * 4);
+    // Erase a random subset, about 1 key out of 2^round
+    size_t mask = (size_t{1} << round) - 1;
+    std::unordered_set<KeyT> kept;
+    size_t numCalls = 0;
+    auto numErased = testSet.erase_if([&](const KeyT& k) {
+      ++numCalls;
+      return (std::hash<KeyT>{}(k) & mask) == 0;
+    });
+    for (auto& k : s)
+      if ((std::hash<KeyT>{}(k) & mask) != 0)
+        kept.insert(k);
+    assertEquals(s.size(), numCalls);
+    assertEquals(s.size() - kept.size(), numErased);
+    assertSameKeys(testSet, kept);
+
+    // retain_if is the complement
+    auto numRetained = kept.size() / 2;
+    std::unordered_set<KeyT> retained;
+    for (auto& k : kept)
+      if (retained.size() < numRetained)
+        retained.insert(k);
+    testSet.retain_if([&](const KeyT& k) { return retained.count(k) == 1; });
+    assertSameKeys(testSet, retained);
+
+    // Inserts and erases still work on the compacted set
+    std::unordered_set<KeyT> more;
+    while (more.size() != numKeys / 2) {
+      auto k = randomKey<KeyT>(numKeys * 4);
+      if (retained.count(k) == 0)
+        assertEquals(more.insert(k).second, testSet.insert(k));
+    }
+    for (auto& k : retained)
+      assertEquals(true, testSet.erase(k));
+    assertSameKeys(testSet, more);
+  }
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  using rh::AoSLayout, rh::SoALayout, rh::KeyOnlyLayout;
+  using U64Traits = KeyTraits<uint64_t>;
+  // Same shape, then different shapes
+  testAlgebra<uint64_t, AoSLayout, U64Traits, ModuloCapacity>(
+      10000, 10000, 9000, 7000);
+  testAlgebra<uint64_t, AoSLayout, U64Traits, ModuloCapacity>(
+      10000, 4000, 6000, 3900);
+  testAlgebra<uint64_t, SoALayout, U64Traits, PowerOfTwoCapacity>(
+      4096, 4096, 4096, 2000);
+  testAlgebra<uint64_t, KeyOnlyLayout, U64Traits, FastRangeCapacity>(
+      5000, 9000, 2000, 8000);
+  testAlgebra<std::string,
+              AoSLayout,
+              StoredHashKeyTraits<std::string>,
+              ModuloCapacity>(3000, 3000, 2900, 2900);
+  testAlgebra<std::string,
+              KeyOnlyLayout,
+              StoredHashKeyTraits<std::string, uint32_t>,
+              ModuloCapacity>(3000, 2000, 1000, 1900);
+
+  // Including full sets, whose clusters wrap around
+  testEraseIf<uint32_t, AoSLayout>(1000, 1000);
+  testEraseIf<uint32_t, AoSLayout>(10000, 9000);
+  testEraseIf<uint64_t, SoALayout>(777, 777);
+  testEraseIf<uint64_t, KeyOnlyLayout>(5000, 4000);
+  testEraseIf<std::string, AoSLayout, StoredHashKeyTraits<std::string>>(
+      2000, 2000);
+  return 0;
+}
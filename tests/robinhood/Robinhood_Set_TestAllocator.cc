@@ -0,0 +1,139 @@
+#include <FixedSizeRobinhoodSet.hpp>
+#include <HugePageAllocator.hpp>
+#include <TestUtil.hpp>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_set>
+
+using namespace ykoh::test_utils;
+namespace rh = ykoh::robinhood;
+
+static std::mt19937 gen32(0);
+
+template <class KeyT, class Layout, class Allocator>
+using SetT = rh::robinhood_set_fixed<KeyT,
+                                     0,
+                                     KeyTraits<KeyT>,
+                                     ModuloCapacity,
+                                     NoStats,
+                                     Layout,
+                                     Allocator>;
+
+template <class KeyT>
+KeyT randomKey() {
+  if constexpr (std::is_same_v<KeyT, std::string>)
+    return "key" + std::to_string(gen32());
+  else
+    return static_cast<KeyT>(gen32());
+}
+
+template <class Set>
+void fillAndCheck(Set& testSet, size_t numKeys) {
+  // Buckets start empty although they were never zeroed explicitly
+  assertEquals(0ul, testSet.size());
+  for (size_t i = 0; i < 100; ++i)
+    assertEquals(true, testSet.find(randomKey<typename Set::key_type>()) ==
+                           testSet.end());
+
+  std::unordered_set<typename Set::key_type> s;
+  while (s.size() != numKeys) {
+    auto k = randomKey<typename Set::key_type>();
+    assertEquals(s.insert(k).second, testSet.insert(k));
+  }
+  for (auto& k : s)
+    assertEquals(k, testSet.find(k)->key);
+  size_t numErased = 0;
+  for (auto& k : s)
+    if (numErased++ % 2 == 0)
+      assertEquals(true, testSet.erase(k));
+  assertEquals(numKeys / 2, testSet.size());
+}
+
+template <class KeyT, class Layout>
+void testHugePageAllocator(rh::HugePageOptions options) {
+  using AllocT = rh::HugePageAllocator<KeyT>;
+  for (size_t round = 0; round < 3; ++round) {
+    // Every round maps fresh pages, possibly at the same address
+    SetT<KeyT, Layout, AllocT> testSet(1 << 18, AllocT(options));
+    fillAndCheck(testSet, (1 << 18) * 3 / 4);
+  }
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testMappings() {
+  // Large mappings are huge page aligned, huge pages or not
+  rh::HugePageAllocator<uint64_t> alloc;
+  auto p = alloc.allocate(1 << 20);
+  assertEquals(0ul, reinterpret_cast<uintptr_t>(p) % (1 << 21));
+  for (size_t i = 0; i < (1 << 20); i += 4096)
+    assertEquals(0ul, p[i]);
+  alloc.deallocate(p, 1 << 20);
+
+  // Small ones are page aligned
+  auto small = alloc.allocate(10);
+  assertEquals(0ul, reinterpret_cast<uintptr_t>(small) % 4096);
+  alloc.deallocate(small, 10);
+
+  // Rebinding keeps the options
+  rh::HugePageAllocator<int> prefaulting(
+      rh::HugePageOptions{.prefaultThreads = 3});
+  rh::HugePageAllocator<char> rebound(prefaulting);
+  auto q = rebound.allocate(5 << 20);
+  assertEquals(char{0}, q[(5 << 20) - 1]);
+  rebound.deallocate(q, 5 << 20);
+  assertEquals(true, prefaulting == rebound);
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testArena() {
+  rh::HugePageArena arena(64 << 20);
+  assertEquals(size_t{64} << 20, arena.capacity());
+
+  // Several tables share the arena
+  using AllocT = rh::ArenaAllocator<uint32_t>;
+  SetT<uint32_t, rh::AoSLayout, AllocT> aos(1 << 16, AllocT(arena));
+  SetT<uint32_t, rh::SoALayout, AllocT> soa(1 << 16, AllocT(arena));
+  SetT<uint32_t, rh::KeyOnlyLayout, AllocT> keyOnly(1 << 16, AllocT(arena));
+  assertEquals(true, arena.bytesUsed() >= aos.memory_usage() +
+                                              soa.memory_usage() +
+                                              keyOnly.memory_usage());
+  fillAndCheck(aos, 60000);
+  fillAndCheck(soa, 60000);
+  fillAndCheck(keyOnly, 60000);
+
+  // Non trivial keys are still constructed
+  using StringAllocT = rh::ArenaAllocator<std::string>;
+  SetT<std::string, rh::AoSLayout, StringAllocT> strings(4096,
+                                                          StringAllocT(arena));
+  fillAndCheck(strings, 3000);
+
+  // Exhausted arenas throw
+  bool threw = false;
+  try {
+    SetT<uint64_t, rh::AoSLayout, rh::ArenaAllocator<uint64_t>> tooLarge(
+        64 << 20, rh::ArenaAllocator<uint64_t>(arena));
+  } catch (const std::bad_alloc&) {
+    threw = true;
+  }
+  assertEquals(true, threw);
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  rh::HugePageOptions defaults;
+  rh::HugePageOptions noHugePages{.useHugeTlb = false,
+                                  .useTransparentHugePages = false};
+  rh::HugePageOptions prefaulted{.prefaultThreads = 4};
+  testHugePageAllocator<uint32_t, rh::AoSLayout>(defaults);
+  testHugePageAllocator<uint32_t, rh::SoALayout>(noHugePages);
+  testHugePageAllocator<uint64_t, rh::KeyOnlyLayout>(prefaulted);
+  testHugePageAllocator<std::string, rh::AoSLayout>(defaults);
+  testMappings();
+  testArena();
+  return 0;
+}
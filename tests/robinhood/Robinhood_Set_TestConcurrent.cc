@@ -0,0 +1,82 @@
+#include <ConcurrentRobinhoodSet.hpp>
+#include <TestUtil.hpp>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace ykoh::test_utils;
+
+// Each writer owns a disjoint key range that it keeps inserting and erasing,
+// while readers check that a set of stable keys is always visible and that
+// keys that were never inserted are never visible.
+template <class KeyT>
+void testConcurrent(size_t numWriters, size_t numReaders, size_t numShards) {
+  constexpr size_t kStableKeys = 20000;
+  constexpr size_t kKeysPerWriter = 5000;
+  constexpr size_t kRounds = 20;
+  const size_t capacity = 2 * (kStableKeys + numWriters * kKeysPerWriter);
+  ykoh::robinhood::concurrent_robinhood_set<KeyT> testSet(capacity, numShards);
+
+  // Stable keys are odd, churned keys are even, absent keys are above all
+  for (KeyT k = 0; k < kStableKeys; ++k)
+    assertEquals(true, testSet.insert(2 * k + 1));
+  const KeyT absentBase = 2 * (kStableKeys + numWriters * kKeysPerWriter);
+
+  std::atomic<bool> writersDone{false};
+  std::atomic<size_t> readerErrors{0};
+  std::atomic<size_t> writerErrors{0};
+
+  std::vector<std::thread> threads;
+  for (size_t w = 0; w < numWriters; ++w) {
+    threads.emplace_back([&, w]() {
+      KeyT base = static_cast<KeyT>(w * kKeysPerWriter);
+      for (size_t round = 0; round < kRounds; ++round) {
+        for (KeyT k = base; k < base + kKeysPerWriter; ++k)
+          writerErrors += !testSet.insert(2 * k);
+        for (KeyT k = base; k < base + kKeysPerWriter; ++k)
+          writerErrors += !testSet.contains(2 * k);
+        for (KeyT k = base; k < base + kKeysPerWriter; ++k)
+          writerErrors += !testSet.erase(2 * k);
+      }
+    });
+  }
+  for (size_t r = 0; r < numReaders; ++r) {
+    threads.emplace_back([&, r]() {
+      KeyT k = static_cast<KeyT>(r);
+      do {
+        for (size_t i = 0; i < 1000; ++i, k = (k + 7) % kStableKeys) {
+          readerErrors += !testSet.contains(2 * k + 1);
+          readerErrors += testSet.contains(absentBase + k);
+        }
+      } while (!writersDone.load(std::memory_order_relaxed));
+    });
+  }
+  for (size_t w = 0; w < numWriters; ++w)
+    threads[w].join();
+  writersDone = true;
+  for (size_t r = 0; r < numReaders; ++r)
+    threads[numWriters + r].join();
+
+  assertEquals(0ul, writerErrors.load());
+  assertEquals(0ul, readerErrors.load());
+  assertEquals(static_cast<size_t>(kStableKeys), testSet.size());
+  for (KeyT k = 0; k < kStableKeys; ++k) {
+    assertEquals(true, testSet.contains(2 * k + 1));
+    assertEquals(false, testSet.contains(2 * k));
+  }
+
+  testSet.clear();
+  assertEquals(0ul, testSet.size());
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testConcurrent<uint32_t>(4, 4, 64);
+  testConcurrent<uint64_t>(8, 2, 16);
+  // Single shard, every writer contends on the same lock
+  testConcurrent<uint64_t>(2, 2, 1);
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include <FixedSizeRobinhoodSetEpoch.hpp>
+#include <TestUtil.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+
+template <typename Key, size_t N = 0>
+using VectorSet = ykoh::robinhood::robinhood_set_fixed_epoch<Key, 0>;
+
+template <typename Key, size_t N>
+using ArraySet = ykoh::robinhood::robinhood_set_fixed_epoch<Key, N>;
+
+using namespace ykoh::test_utils;
+
+static std::mt19937 gen32(0);
+
+template <template <class, size_t> class SetTemplate, class KeyT, size_t N>
+void testEpochSet() {
+  using SetType = SetTemplate<KeyT, N>;
+  constexpr bool isDynamic = std::is_constructible_v<SetType, size_t>;
+  SetType testSet = [&]() {
+    if constexpr (isDynamic)
+      return SetType{N};
+    else
+      return SetType{};
+  }();
+
+  // Reuse the same set as a scratch set over many rounds of small fills
+  for (size_t round = 0; round < 50; ++round) {
+    std::unordered_set<KeyT> s;
+    size_t fill = 1 + gen32() % (N / 8);
+    while (s.size() != fill) {
+      auto k = static_cast<KeyT>(gen32());
+      assertEquals(s.insert(k).second, testSet.insert(k));
+    }
+    assertEquals(s.size(), testSet.size());
+
+    // Erase a few, keys of previous rounds must never show up
+    for (size_t i = 0; i < fill / 3; ++i) {
+      auto k = *s.begin();
+      s.erase(k);
+      assertEquals(true, testSet.erase(k));
+      assertEquals(false, testSet.contains(k));
+    }
+    for (auto k : s)
+      assertEquals(k, testSet.find(k)->key);
+
+    // Iteration visits exactly the live entries, in bucket order
+    size_t visited = 0;
+    size_t lastPos = 0;
+    for (auto it = testSet.begin(); it != testSet.end(); ++it) {
+      assertEquals(true, s.count(it->key) == 1);
+      assertEquals(true, visited == 0 || it.position() > lastPos);
+      lastPos = it.position();
+      ++visited;
+    }
+    assertEquals(s.size(), visited);
+
+    testSet.clear();
+    assertEquals(0ul, testSet.size());
+    assertEquals(true, testSet.begin() == testSet.end());
+    for (auto k : s)
+      assertEquals(false, testSet.contains(k));
+  }
+
+  // Fill to the brim after all the clears
+  std::unordered_set<KeyT> s;
+  while (s.size() != N) {
+    auto k = static_cast<KeyT>(gen32());
+    if (s.insert(k).second)
+      assertEquals(true, testSet.insert(k));
+  }
+  assertEquals(true, testSet.isFull());
+  size_t visited = 0;
+  for (auto& e : testSet) {
+    assertEquals(true, s.count(e.key) == 1);
+    ++visited;
+  }
+  assertEquals(static_cast<size_t>(N), visited);
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testEpochSet<VectorSet, uint32_t, 10384>();
+  testEpochSet<ArraySet, uint32_t, 10384>();
+  testEpochSet<VectorSet, uint64_t, 5000>();
+  testEpochSet<ArraySet, int64_t, 130>();
+  return 0;
+}
@@ -0,0 +1,79 @@
+#include <RobinhoodSet.hpp>
+#include <TestUtil.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+
+using namespace ykoh::test_utils;
+
+static std::mt19937 gen32(0);
+
+template <class KeyT, class CapacityPolicy = ModuloCapacity>
+void testGrowable(size_t numKeys, float maxLoadFactor) {
+  ykoh::robinhood::robinhood_set<KeyT, KeyTraits<KeyT>, CapacityPolicy>
+      testSet(16, maxLoadFactor);
+  std::unordered_set<KeyT> s;
+
+  // Grow from the minimum capacity, checking every key while migrations are
+  // in flight
+  bool sawRehash = false;
+  while (s.size() != numKeys) {
+    auto key = static_cast<KeyT>(gen32());
+    assertEquals(s.insert(key).second, testSet.insert(key));
+    sawRehash |= testSet.isRehashing();
+    assertEquals(true, testSet.load_factor() <= maxLoadFactor);
+  }
+  assertEquals(true, sawRehash);
+  assertEquals(s.size(), testSet.size());
+  for (auto key : s)
+    assertEquals(true, testSet.contains(key));
+
+  // Duplicates are rejected
+  for (auto key : s)
+    assertEquals(false, testSet.insert(key));
+
+  // Erase half of the keys, some of them mid-migration
+  std::unordered_set<KeyT> deleted;
+  while (deleted.size() != numKeys / 2) {
+    auto k = *s.begin();
+    s.erase(k);
+    deleted.insert(k);
+    assertEquals(true, testSet.erase(k));
+    assertEquals(false, testSet.contains(k));
+  }
+  for (auto& k : deleted)
+    assertEquals(false, testSet.erase(k));
+  for (auto& k : s)
+    assertEquals(k, *testSet.find(k));
+  assertEquals(s.size(), testSet.size());
+
+  // Completing the migration keeps every key reachable
+  testSet.finishRehash();
+  assertEquals(false, testSet.isRehashing());
+  for (auto& k : s)
+    assertEquals(true, testSet.contains(k));
+
+  // Reserve avoids any further growth
+  auto toReserve = testSet.size() + numKeys;
+  testSet.reserve(toReserve);
+  auto reservedCap = testSet.capacity();
+  while (testSet.size() != toReserve)
+    testSet.insert(static_cast<KeyT>(gen32()));
+  assertEquals(reservedCap, testSet.capacity());
+
+  testSet.clear();
+  assertEquals(0ul, testSet.size());
+  assertEquals(false, testSet.contains(*s.begin()));
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testGrowable<uint32_t>(100000, 0.875f);
+  testGrowable<uint64_t>(100000, 0.5f);
+  testGrowable<int32_t>(50000, 0.95f);
+  testGrowable<uint64_t, PowerOfTwoCapacity>(100000, 0.875f);
+  testGrowable<uint32_t, FastRangeCapacity>(100000, 0.875f);
+  return 0;
+}
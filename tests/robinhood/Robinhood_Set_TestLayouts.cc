@@ -0,0 +1,131 @@
+#include <FixedSizeRobinhoodSet.hpp>
+#include <KeyTraits.hpp>
+#include <StatsPolicy.hpp>
+#include <TestUtil.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace ykoh::test_utils;
+namespace rh = ykoh::robinhood;
+
+template <class KeyT, size_t N, class Layout, class Traits = KeyTraits<KeyT>>
+using SetT = rh::robinhood_set_fixed<KeyT,
+                                     N,
+                                     Traits,
+                                     ModuloCapacity,
+                                     CountingStats,
+                                     Layout>;
+
+template <class KeyT>
+KeyT randomKey(std::mt19937& gen) {
+  if constexpr (std::is_same_v<KeyT, std::string>)
+    return "key" + std::to_string(gen() % 100000);
+  else
+    return static_cast<KeyT>(gen() % 100000);
+}
+
+template <class Set>
+Set makeSet(size_t capacity) {
+  if constexpr (std::is_constructible_v<Set, size_t>)
+    return Set{capacity};
+  else
+    return Set{};
+}
+
+// Runs the same random workload on a set, checking it against a reference
+// and returning its stats, which must not depend on the layout
+template <class Set, class KeyT>
+RobinhoodStats runWorkload(size_t capacity) {
+  std::mt19937 gen(7);
+  auto testSet = makeSet<Set>(capacity);
+  std::unordered_set<KeyT> s;
+  for (size_t round = 0; round < 4; ++round) {
+    // Fill up to the brim, then erase a third of the keys
+    while (s.size() != capacity) {
+      auto k = randomKey<KeyT>(gen);
+      assertEquals(s.insert(k).second, testSet.insert(k));
+    }
+    assertEquals(true, testSet.isFull());
+    assertEquals(false, testSet.insert(randomKey<KeyT>(gen)));
+    for (auto& k : s)
+      assertEquals(k, testSet.find(k)->key);
+    for (size_t i = 0; i < capacity / 3; ++i) {
+      auto k = randomKey<KeyT>(gen);
+      assertEquals(s.erase(k) == 1, testSet.erase(k));
+      assertEquals(true, testSet.find(k) == testSet.end());
+    }
+    for (auto& k : s)
+      assertEquals(k, testSet.find(k)->key);
+  }
+
+  // Bulk construction and clear
+  std::vector<KeyT> keys(s.begin(), s.end());
+  testSet.clear();
+  assertEquals(0ul, testSet.size());
+  for (auto& k : keys)
+    assertEquals(true, testSet.find(k) == testSet.end());
+  assertEquals(keys.size(), testSet.assign(keys.begin(), keys.end()));
+  for (auto& k : keys)
+    assertEquals(k, testSet.find(k)->key);
+  return testSet.stats();
+}
+
+void assertSameStats(const RobinhoodStats& a, const RobinhoodStats& b) {
+  assertEquals(a.inserts, b.inserts);
+  assertEquals(a.insertProbes, b.insertProbes);
+  assertEquals(a.insertSwaps, b.insertSwaps);
+  assertEquals(a.findHits, b.findHits);
+  assertEquals(a.findMisses, b.findMisses);
+  assertEquals(a.findProbes, b.findProbes);
+  assertEquals(a.erases, b.erases);
+  assertEquals(a.eraseProbes, b.eraseProbes);
+  assertEquals(a.backshifts, b.backshifts);
+  assertEquals(a.size, b.size);
+  assertEquals(a.maxPsl, b.maxPsl);
+  assertEquals(true, a.pslHistogram == b.pslHistogram);
+}
+
+template <class KeyT, size_t N, class Traits = KeyTraits<KeyT>>
+void testLayouts(size_t capacity) {
+  auto aosStats =
+      runWorkload<SetT<KeyT, N, rh::AoSLayout, Traits>, KeyT>(capacity);
+  auto soaStats =
+      runWorkload<SetT<KeyT, N, rh::SoALayout, Traits>, KeyT>(capacity);
+  auto keyOnlyStats =
+      runWorkload<SetT<KeyT, N, rh::KeyOnlyLayout, Traits>, KeyT>(capacity);
+  // Same buckets whatever the layout
+  assertSameStats(aosStats, soaStats);
+  assertSameStats(aosStats, keyOnlyStats);
+  assertEquals(true, aosStats.backshifts > 0 && aosStats.insertSwaps > 0);
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testMemoryUsage() {
+  SetT<uint32_t, 0, rh::AoSLayout> aos(1024);
+  SetT<uint32_t, 0, rh::SoALayout> soa(1024);
+  SetT<uint32_t, 0, rh::KeyOnlyLayout> keyOnly(1024);
+  assertEquals(1024ul * 8, aos.memory_usage());
+  assertEquals(1024ul * 8, soa.memory_usage());
+  assertEquals(1024ul * 4 + 1024 / 8, keyOnly.memory_usage());
+  SetT<uint64_t, 0, rh::SoALayout> soa64(1024);
+  assertEquals(1024ul * 12, soa64.memory_usage());
+  SetT<uint64_t, 0, rh::KeyOnlyLayout, StoredHashKeyTraits<uint64_t>>
+      keyOnlyHashed(1024);
+  assertEquals(1024ul * 16 + 1024 / 8, keyOnlyHashed.memory_usage());
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testLayouts<uint32_t, 0>(10384);
+  testLayouts<uint32_t, 1000>(1000);
+  testLayouts<uint64_t, 0, StoredHashKeyTraits<uint64_t>>(5000);
+  testLayouts<std::string, 0>(3000);
+  testLayouts<std::string, 0, StoredHashKeyTraits<std::string, uint32_t>>(
+      3000);
+  testMemoryUsage();
+  return 0;
+}
@@ -0,0 +1,145 @@
+#include <CapacityPolicy.hpp>
+#include <FixedSizeRobinhoodSetPacked.hpp>
+#include <KeyTraits.hpp>
+#include <TestUtil.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+
+template <typename Key, size_t N = 0>
+using VectorSet = ykoh::robinhood::robinhood_set_fixed_packed<Key, 0>;
+
+template <typename Key, size_t N>
+using ArraySet = ykoh::robinhood::robinhood_set_fixed_packed<Key, N>;
+
+template <typename Key, size_t N>
+using FastRangeSet =
+    ykoh::robinhood::robinhood_set_fixed_packed<Key,
+                                                N,
+                                                KeyTraits<Key>,
+                                                FastRangeCapacity>;
+
+using namespace ykoh::test_utils;
+
+static std::mt19937 gen32(0);
+
+// Checks the robinhood invariant: PSLs grow by at most one per bucket
+template <class SetT>
+void checkPsls(const SetT& testSet) {
+  for (size_t pos = 0; pos < testSet.capacity(); ++pos) {
+    auto next = (pos + 1) % testSet.capacity();
+    if (testSet.isOccupiedAtPos(next) && testSet.pslAtPos(next) > 0) {
+      assertEquals(true, testSet.isOccupiedAtPos(pos));
+      assertEquals(true, testSet.pslAtPos(next) <= testSet.pslAtPos(pos) + 1);
+    }
+  }
+}
+
+template <template <class, size_t> class SetTemplate, class KeyT, size_t N>
+void testSet(size_t numKeys) {
+  using SetType = SetTemplate<KeyT, N>;
+  auto testSet = [&]() {
+    if constexpr (std::is_same_v<SetType, VectorSet<KeyT>>)
+      return VectorSet<KeyT>{N};
+    else
+      return SetType{};
+  }();
+
+  std::unordered_set<KeyT> s;
+  while (s.size() != numKeys) {
+    auto key = static_cast<KeyT>(gen32());
+    if (!s.insert(key).second) {
+      assertEquals(false, testSet.insert(key));
+      continue;
+    }
+    assertEquals(true, testSet.insert(key));
+  }
+  checkPsls(testSet);
+  assertEquals(s.size(), testSet.size());
+  for (auto key : s)
+    assertEquals(key, *testSet.find(key));
+
+  // Misses, most of them run into an early exit
+  for (size_t i = 0; i < numKeys; ++i) {
+    auto key = static_cast<KeyT>(gen32());
+    assertEquals(s.count(key) == 1, testSet.contains(key));
+  }
+
+  // Delete half and check again
+  std::unordered_set<KeyT> deleted;
+  while (deleted.size() != numKeys / 2) {
+    auto k = *s.begin();
+    s.erase(k);
+    deleted.insert(k);
+    assertEquals(true, testSet.erase(k));
+  }
+  checkPsls(testSet);
+  for (auto& k : deleted)
+    assertEquals(true, testSet.find(k) == testSet.end());
+  for (auto& k : s)
+    assertEquals(true, testSet.contains(k));
+
+  testSet.clear();
+  assertEquals(0ul, testSet.size());
+  for (auto& k : s)
+    assertEquals(false, testSet.contains(k));
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// Replays the probes of missing keys and counts the buckets whose PSL and
+// fingerprint both match, each one costs a key comparison for nothing.
+// The fingerprint must not come from the hash bits the home is taken from,
+// or keys of a cluster all share it and most candidates match
+template <class SetT, class Policy>
+void testFalseFingerprintMatches(SetT testSet, size_t numKeys) {
+  using KeyT = uint64_t;
+  std::unordered_set<KeyT> s;
+  while (s.size() != numKeys) {
+    auto key = static_cast<KeyT>(gen32()) << 32 | gen32();
+    if (s.insert(key).second)
+      assertEquals(true, testSet.insert(key));
+  }
+
+  size_t candidates = 0, falseMatches = 0;
+  for (size_t i = 0; i < 100000; ++i) {
+    auto key = static_cast<KeyT>(gen32()) << 32 | gen32();
+    if (s.count(key))
+      continue;
+    auto hash = testSet.hash_function()(key);
+    auto fp = Policy::fingerprint(hash);
+    auto pos = Policy::reduce(hash, testSet.capacity());
+    for (size_t psl = 0;
+         testSet.isOccupiedAtPos(pos) && testSet.pslAtPos(pos) >= psl;
+         ++psl, pos = Policy::next(pos, testSet.capacity())) {
+      if (testSet.pslAtPos(pos) == psl) {
+        ++candidates;
+        falseMatches += testSet.fingerprintAtPos(pos) == fp;
+      }
+    }
+  }
+  // About 1 in 256 for independent bits, allow 4x that
+  assertEquals(true, candidates > 0);
+  assertEquals(true, falseMatches * 64 < candidates);
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  // Tiny tables, windows wrap around more than once
+  testSet<VectorSet, uint32_t, 5>(5);
+  testSet<ArraySet, uint32_t, 7>(6);
+  // Up to 95% load
+  testSet<VectorSet, uint32_t, 10384>(9864);
+  testSet<ArraySet, uint32_t, 10384>(9864);
+  testSet<VectorSet, uint64_t, 5192>(4672);
+  testSet<ArraySet, int64_t, 5192>(4672);
+  testSet<FastRangeSet, uint64_t, 5192>(4672);
+  // 90% load, long clusters
+  testFalseFingerprintMatches<VectorSet<uint64_t>, ModuloCapacity>(
+      VectorSet<uint64_t>{100000}, 90000);
+  testFalseFingerprintMatches<FastRangeSet<uint64_t, 0>, FastRangeCapacity>(
+      FastRangeSet<uint64_t, 0>{100000}, 90000);
+  return 0;
+}
@@ -0,0 +1,192 @@
+#include <FixedSizeRobinhoodSet.hpp>
+#include <KeyTraits.hpp>
+#include <StatsPolicy.hpp>
+#include <TestUtil.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace ykoh::test_utils;
+namespace rh = ykoh::robinhood;
+
+static std::mt19937 gen32(0);
+
+static constexpr size_t kBand = 1024;
+
+// Homes every key in the second half of a band of kBand buckets, so that
+// every band overflows into the next one and the last one wraps around
+struct BandedHash {
+  inline size_t operator()(uint64_t k) const noexcept {
+    auto h = IntMurMurHash3{}(k);
+    return (h / kBand) * kBand + kBand / 2 + h % (kBand / 2);
+  }
+};
+struct BandedTraits {
+  using Hasher = BandedHash;
+  using EqualTo = std::equal_to<uint64_t>;
+};
+
+template <class KeyT,
+          class Layout = rh::AoSLayout,
+          class Traits = KeyTraits<KeyT>,
+          class CapacityPolicy = ModuloCapacity>
+using SetT = rh::robinhood_set_fixed<KeyT,
+                                     0,
+                                     Traits,
+                                     CapacityPolicy,
+                                     CountingStats,
+                                     Layout>;
+
+template <class KeyT>
+KeyT randomKey(size_t range) {
+  if constexpr (std::is_same_v<KeyT, std::string>)
+    return "key" + std::to_string(gen32() % range);
+  else
+    return static_cast<KeyT>(gen32() % range);
+}
+
+// Same keys in the same buckets, with the same PSLs
+template <class Set, class KeyT>
+void assertSameBuckets(Set& expected,
+                       Set& actual,
+                       const std::unordered_set<KeyT>& keys) {
+  assertEquals(expected.size(), actual.size());
+  assertEquals(keys.size(), actual.size());
+  if constexpr (requires { actual.data(); }) {
+    for (size_t pos = 0; pos < actual.capacity(); ++pos) {
+      auto& e = expected.data()[pos];
+      auto& a = actual.data()[pos];
+      assertEquals(e.isOccupied(), a.isOccupied());
+      if (e.isOccupied()) {
+        assertEquals(e.key, a.key);
+        assertEquals(e.psl, a.psl);
+        assertEquals(true, e.hash == a.hash);
+      }
+    }
+  } else {
+    for (auto& k : keys) {
+      auto it = actual.find(k);
+      assertEquals(k, it->key);
+      assertEquals(expected.find(k).position(), it.position());
+    }
+  }
+  assertEquals(true,
+               expected.stats().pslHistogram == actual.stats().pslHistogram);
+}
+
+template <class KeyT>
+std::vector<KeyT> randomKeys(size_t numKeys, size_t range) {
+  std::vector<KeyT> keys(numKeys);
+  for (auto& k : keys)
+    k = randomKey<KeyT>(range);
+  return keys;
+}
+
+// Builds the same keys, duplicates included, with assign and with
+// assign_parallel on every thread count
+template <class KeyT, class Layout, class Traits, class CapacityPolicy>
+void testMatchesAssign(size_t capacity, const std::vector<KeyT>& keys) {
+  using Set = SetT<KeyT, Layout, Traits, CapacityPolicy>;
+  std::unordered_set<KeyT> s(keys.begin(), keys.end());
+
+  Set expected(capacity);
+  assertEquals(s.size(), expected.assign(keys.begin(), keys.end()));
+  for (size_t numThreads : {1, 2, 3, 4, 7, 8, 16}) {
+    Set actual(capacity);
+    assertEquals(s.size(), actual.assign_parallel(keys.begin(), keys.end(),
+                                                  numThreads));
+    assertSameBuckets(expected, actual, s);
+    // Reassigning replaces the previous content
+    assertEquals(s.size(), actual.assign_parallel(keys.rbegin(), keys.rend(),
+                                                  numThreads));
+    Set reversed(capacity);
+    reversed.assign(keys.rbegin(), keys.rend());
+    assertSameBuckets(reversed, actual, s);
+  }
+
+  // Non random access input is hashed sequentially, laid out in parallel
+  std::list<KeyT> keyList(keys.begin(), keys.end());
+  Set fromList(capacity);
+  fromList.assign_parallel(keyList.begin(), keyList.end(), 4);
+  assertSameBuckets(expected, fromList, s);
+
+  // Still a working set
+  for (auto& k : s)
+    assertEquals(true, fromList.erase(k));
+  assertEquals(0ul, fromList.size());
+  for (auto& k : s)
+    assertEquals(true, fromList.insert(k));
+  assertEquals(s.size(), fromList.size());
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testTooManyKeys() {
+  using Set = SetT<uint64_t>;
+  std::vector<uint64_t> keys(20000);
+  for (size_t i = 0; i < keys.size(); ++i)
+    keys[i] = i;
+  Set testSet(keys.size() - 1);
+  std::vector<uint64_t> before(keys.begin(), keys.begin() + 1000);
+  testSet.assign(before.begin(), before.end());
+  bool threw = false;
+  try {
+    testSet.assign_parallel(keys.begin(), keys.end(), 4);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assertEquals(true, threw);
+  assertEquals(before.size(), testSet.size());
+  for (auto k : before)
+    assertEquals(k, testSet.find(k)->key);
+
+  // No bucket at all, rejected before computing any home
+  Set emptySet(0);
+  threw = false;
+  try {
+    emptySet.assign_parallel(keys.begin(), keys.end(), 4);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assertEquals(true, threw);
+  assertEquals(0ul, emptySet.assign(keys.begin(), keys.begin()));
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  using rh::AoSLayout, rh::SoALayout, rh::KeyOnlyLayout;
+  using U64Traits = KeyTraits<uint64_t>;
+  // Random homes
+  testMatchesAssign<uint64_t, AoSLayout, U64Traits, ModuloCapacity>(
+      70001, randomKeys<uint64_t>(80000, 100000));
+  testMatchesAssign<uint64_t, SoALayout, U64Traits, PowerOfTwoCapacity>(
+      65536, randomKeys<uint64_t>(70000, 80000));
+  testMatchesAssign<uint64_t, KeyOnlyLayout, U64Traits, FastRangeCapacity>(
+      50000, randomKeys<uint64_t>(60000, 60000));
+  testMatchesAssign<std::string,
+                    AoSLayout,
+                    StoredHashKeyTraits<std::string>,
+                    ModuloCapacity>(40000,
+                                    randomKeys<std::string>(40000, 40000));
+  // Full set, a single cluster wrapping around
+  std::vector<uint64_t> allKeys(50000);
+  std::iota(allKeys.begin(), allKeys.end(), 0);
+  std::shuffle(allKeys.begin(), allKeys.end(), gen32);
+  testMatchesAssign<uint64_t, AoSLayout, U64Traits, ModuloCapacity>(
+      allKeys.size(), allKeys);
+  // Overflow chains cross every region boundary and wrap around
+  testMatchesAssign<uint64_t, AoSLayout, BandedTraits, ModuloCapacity>(
+      64 * kBand, randomKeys<uint64_t>(60000, 1 << 20));
+  testMatchesAssign<uint64_t, SoALayout, BandedTraits, ModuloCapacity>(
+      64 * kBand, randomKeys<uint64_t>(66000, 66000));
+  testTooManyKeys();
+  return 0;
+}
@@ -0,0 +1,121 @@
+#include <FixedSizeRobinhoodSet.hpp>
+#include <RobinhoodSnapshot.hpp>
+#include <TestUtil.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include <unordered_set>
+
+using namespace ykoh::test_utils;
+namespace rh = ykoh::robinhood;
+
+static std::mt19937 gen32(0);
+
+template <class KeyT, size_t N, class CapacityPolicy>
+void testSnapshot(size_t numKeys) {
+  using SetT =
+      rh::robinhood_set_fixed<KeyT, N, KeyTraits<KeyT>, CapacityPolicy>;
+  using ViewT = rh::robinhood_set_view<KeyT, KeyTraits<KeyT>, CapacityPolicy>;
+  auto path = (std::filesystem::temp_directory_path() /
+               ("rh_snapshot_test_" + std::to_string(::getpid())))
+                  .string();
+
+  auto testSet = [&]() {
+    if constexpr (N == rh::DYNAMIC_SIZE)
+      return SetT{numKeys * 5 / 4};
+    else
+      return SetT{};
+  }();
+  std::unordered_set<KeyT> s;
+  while (s.size() != numKeys) {
+    auto k = static_cast<KeyT>(gen32());
+    if (s.insert(k).second)
+      assertEquals(true, testSet.insert(k));
+  }
+  rh::save_snapshot(testSet, path);
+
+  {
+    ViewT view(path);
+    assertEquals(testSet.size(), view.size());
+    assertEquals(testSet.capacity(), view.capacity());
+    view.prefetch();
+    for (auto k : s)
+      assertEquals(k, *view.find(k));
+    for (size_t i = 0; i < numKeys; ++i) {
+      auto k = static_cast<KeyT>(gen32());
+      assertEquals(s.count(k) == 1, view.contains(k));
+    }
+
+    // Views can be moved around without remapping
+    ViewT moved = std::move(view);
+    for (auto k : s)
+      assertEquals(true, moved.contains(k));
+  }
+
+  // Snapshots are rejected by views with a different key type or policy,
+  // including keys of the same size
+  auto rejects = [&](auto viewTag) {
+    using WrongViewT = typename decltype(viewTag)::type;
+    try {
+      WrongViewT wrongView(path);
+    } catch (const std::runtime_error&) {
+      return true;
+    }
+    return false;
+  };
+  using WrongSignT = std::conditional_t<std::is_signed_v<KeyT>,
+                                        std::make_unsigned_t<KeyT>,
+                                        std::make_signed_t<KeyT>>;
+  using WrongSizeViewT =
+      rh::robinhood_set_view<uint16_t, KeyTraits<uint16_t>, CapacityPolicy>;
+  using WrongSignViewT =
+      rh::robinhood_set_view<WrongSignT, KeyTraits<WrongSignT>, CapacityPolicy>;
+  assertEquals(true, rejects(std::type_identity<WrongSizeViewT>{}));
+  assertEquals(true, rejects(std::type_identity<WrongSignViewT>{}));
+
+  // Same keys, same layout, same file: neither padding nor the stale keys
+  // left in empty buckets by other keys end up in the snapshot
+  if constexpr (N == rh::DYNAMIC_SIZE) {
+    SetT other{testSet.capacity()};
+    for (size_t i = 0; i < numKeys; ++i)
+      other.insert(static_cast<KeyT>(gen32()));
+    other.clear();
+    SetT fresh{testSet.capacity()};
+    for (auto k : s)
+      other.insert(k), fresh.insert(k);
+    auto otherPath = path + "_other";
+    rh::save_snapshot(fresh, path);
+    rh::save_snapshot(other, otherPath);
+    auto readAll = [](const std::string& p) {
+      std::ifstream in(p, std::ios::binary);
+      return std::string(std::istreambuf_iterator<char>(in), {});
+    };
+    assertEquals(true, readAll(path) == readAll(otherPath));
+    std::filesystem::remove(otherPath);
+  }
+
+  std::filesystem::remove(path);
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testSnapshot<uint32_t, rh::DYNAMIC_SIZE, ModuloCapacity>(50000);
+  testSnapshot<uint64_t, rh::DYNAMIC_SIZE, PowerOfTwoCapacity>(50000);
+  testSnapshot<int64_t, 8192, FastRangeCapacity>(6000);
+
+  // Missing files are reported
+  bool rejected = false;
+  try {
+    rh::robinhood_set_view<uint32_t> missing("/nonexistent/rh_snapshot");
+  } catch (const std::runtime_error&) {
+    rejected = true;
+  }
+  assertEquals(true, rejected);
+  return 0;
+}
@@ -0,0 +1,141 @@
+#include <FixedSizeRobinhoodSet.hpp>
+#include <KeyTraits.hpp>
+#include <RobinhoodSet.hpp>
+#include <TestUtil.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+
+using namespace ykoh::test_utils;
+namespace rh = ykoh::robinhood;
+
+static std::mt19937 gen32(0);
+
+// Counts every hash and key comparison
+static size_t numHashes = 0;
+static size_t numCompares = 0;
+struct CountingTraits {
+  struct Hasher {
+    size_t operator()(const std::string& s) const {
+      ++numHashes;
+      return StringHash{}(s);
+    }
+  };
+  struct EqualTo {
+    bool operator()(const std::string& a, const std::string& b) const {
+      ++numCompares;
+      return a == b;
+    }
+  };
+};
+
+// Caching nothing does not grow the buckets
+static_assert(sizeof(rh::robinhood_set_fixed<uint32_t>::EntryT) == 8);
+static_assert(
+    sizeof(rh::robinhood_set_fixed<uint32_t,
+                                   0,
+                                   StoredHashKeyTraits<uint32_t, uint32_t>>::
+               EntryT) == 12);
+static_assert(FullStoredHashTraits<StoredHashKeyTraits<std::string>>);
+static_assert(!FullStoredHashTraits<
+              StoredHashKeyTraits<std::string, uint32_t, CountingTraits>>);
+
+std::string randomKey() {
+  return "key" + std::to_string(gen32());
+}
+
+template <class Traits>
+void testFixed(size_t capacity) {
+  rh::robinhood_set_fixed<std::string, 0, Traits> testSet(capacity);
+  std::unordered_set<std::string> s;
+  while (s.size() != capacity * 9 / 10) {
+    auto k = randomKey();
+    assertEquals(s.insert(k).second, testSet.insert(k));
+  }
+  for (auto& k : s)
+    assertEquals(k, testSet.find(k)->key);
+
+  // Misses almost never compare keys once hashes are cached, a truncated
+  // hash lets a few false positives through
+  numCompares = 0;
+  for (size_t i = 0; i < 1000; ++i)
+    assertEquals(true, testSet.find("miss" + std::to_string(i)) ==
+                           testSet.end());
+  if constexpr (FullStoredHashTraits<Traits>)
+    assertEquals(0ul, numCompares);
+  else if constexpr (StoredHashTraits<Traits>)
+    assertEquals(true, numCompares < 100);
+  else
+    assertEquals(true, numCompares > 1000);
+
+  // Erase half, backshifted entries keep their hashes
+  std::vector<std::string> erased(s.begin(), s.end());
+  erased.resize(erased.size() / 2);
+  for (auto& k : erased) {
+    assertEquals(true, testSet.erase(k));
+    s.erase(k);
+  }
+  for (auto& k : erased)
+    assertEquals(true, testSet.find(k) == testSet.end());
+  for (auto& k : s) {
+    auto it = testSet.find(k);
+    assertEquals(k, it->key);
+    if constexpr (StoredHashTraits<Traits>)
+      assertEquals(static_cast<typename Traits::StoredHashT>(StringHash{}(k)),
+                   it->hash);
+  }
+
+  // Bulk construction caches hashes too
+  std::vector<std::string> keys(s.begin(), s.end());
+  rh::robinhood_set_fixed<std::string, 0, Traits> bulkSet(capacity,
+                                                          keys.begin(),
+                                                          keys.end());
+  for (auto& k : s)
+    assertEquals(true, bulkSet.find(k) != bulkSet.end());
+  assertEquals(true, bulkSet.find("miss") == bulkSet.end());
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+template <class Traits>
+void testGrowable(size_t numKeys) {
+  rh::robinhood_set<std::string, Traits> testSet;
+  std::unordered_set<std::string> s;
+  size_t numInserts = 0;
+  numHashes = 0;
+  while (s.size() != numKeys) {
+    auto k = randomKey();
+    assertEquals(s.insert(k).second, testSet.insert(k));
+    ++numInserts;
+  }
+  // Every insert hashes its key once, even across migrations
+  if constexpr (FullStoredHashTraits<Traits>)
+    assertEquals(numInserts, numHashes);
+
+  // Growing never calls the hasher with full cached hashes
+  numHashes = 0;
+  testSet.reserve(numKeys * 4);
+  if constexpr (FullStoredHashTraits<Traits>)
+    assertEquals(0ul, numHashes);
+  else
+    assertEquals(true, numHashes >= numKeys);
+  assertEquals(s.size(), testSet.size());
+  for (auto& k : s)
+    assertEquals(true, testSet.contains(k));
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testFixed<CountingTraits>(4096);
+  testFixed<StoredHashKeyTraits<std::string, size_t, CountingTraits>>(4096);
+  testFixed<StoredHashKeyTraits<std::string, uint32_t, CountingTraits>>(4096);
+  testFixed<StoredHashKeyTraits<std::string, uint8_t, CountingTraits>>(1000);
+  testGrowable<CountingTraits>(5000);
+  testGrowable<StoredHashKeyTraits<std::string, size_t, CountingTraits>>(5000);
+  testGrowable<StoredHashKeyTraits<std::string, uint16_t, CountingTraits>>(
+      5000);
+  return 0;
+}
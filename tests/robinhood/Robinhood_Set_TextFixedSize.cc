@@ -6,7 +6,9 @@
 #include <ios>
 #include <iostream>
 #include <random>
+#include <stdexcept>
 #include <unordered_set>
+#include <vector>
 
 template <typename Key, size_t N = 0>
 using VectorMap = ykoh::robinhood::robinhood_set_fixed<Key, 0>;
@@ -14,6 +16,26 @@ using VectorMap = ykoh::robinhood::robinhood_set_fixed<Key, 0>;
 template <typename Key, size_t N>
 using ArrayMap = ykoh::robinhood::robinhood_set_fixed<Key, N>;
 
+template <typename Key, size_t N = 0>
+using VectorMapPow2 =
+    ykoh::robinhood::robinhood_set_fixed<Key, 0, KeyTraits<Key>,
+                                         PowerOfTwoCapacity>;
+
+template <typename Key, size_t N>
+using ArrayMapPow2 =
+    ykoh::robinhood::robinhood_set_fixed<Key, N, KeyTraits<Key>,
+                                         PowerOfTwoCapacity>;
+
+template <typename Key, size_t N = 0>
+using VectorMapFastRange =
+    ykoh::robinhood::robinhood_set_fixed<Key, 0, KeyTraits<Key>,
+                                         FastRangeCapacity>;
+
+template <typename Key, size_t N>
+using ArrayMapFastRange =
+    ykoh::robinhood::robinhood_set_fixed<Key, N, KeyTraits<Key>,
+                                         FastRangeCapacity>;
+
 using namespace ykoh::test_utils;
 
 static std::mt19937 gen32(0);
@@ -28,19 +50,21 @@ void printEntryAtBucket(const Entry& e, size_t bucketPos) {
 template <template <class, size_t> class MapTemplate, class KeyT, size_t N>
 void testMap() {
   using MapType = MapTemplate<KeyT, N>;
+  // Only the dynamic alloc variants take a capacity
+  constexpr bool isDynamic = std::is_constructible_v<MapType, size_t>;
   // Instantiate the map
   MapType testMap = [&]() {
-    if constexpr (std::is_same_v<MapType, VectorMap<KeyT>>) {
-      return VectorMap<KeyT>{N};
+    if constexpr (isDynamic) {
+      return MapType{N};
     } else
-      return ArrayMap<KeyT, N>{};
+      return MapType{};
   }();
 
   // Check that the underlying buffer for the buckets are correct
   // Check that IntMurMurHash3 is used for integral keys
   using BufferT = std::remove_reference_t<decltype(testMap.data())>;
   using EntryT = typename decltype(testMap)::EntryT;
-  if constexpr (std::is_same_v<MapType, VectorMap<KeyT>>)
+  if constexpr (isDynamic)
     static_assert(std::is_same_v<BufferT, std::vector<EntryT>>);
   else
     static_assert(std::is_same_v<BufferT, std::array<EntryT, N>>);
@@ -75,6 +99,23 @@ void testMap() {
   assertEquals(testMap.size(), s.size());
   assertEquals(testMap.isFull(), true);
 
+  // Batched lookups agree with single lookups, half of them are misses
+  std::vector<KeyT> batch(s.begin(), s.end());
+  while (batch.size() != 2 * s.size())
+    batch.push_back(gen32());
+  std::vector<uint64_t> bitmap((batch.size() + 63) / 64);
+  size_t expectedFound = 0;
+  for (auto& k : batch)
+    expectedFound += s.count(k);
+  assertEquals(expectedFound, testMap.contains_batch(batch, bitmap));
+  std::vector<typename MapType::iterator> batchIts(batch.size());
+  testMap.find_batch(batch, batchIts);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    bool isFound = (bitmap[i / 64] >> (i % 64)) & 1;
+    assertEquals(s.count(batch[i]) == 1, isFound);
+    assertEquals(testMap.find(batch[i]) == batchIts[i], true);
+  }
+
   // Now delete some and check
   std::unordered_set<KeyT> deleted;
   while (deleted.size() != sNumKeys) {
@@ -110,6 +151,22 @@ void testMap() {
     assertEquals(key, testMap.find(key)->key);
   }
 
+  // Batched re-insertion and erasure of the deleted keys
+  std::vector<KeyT> deletedBatch(deleted.begin(), deleted.end());
+  deletedBatch.push_back(*s.begin());
+  bitmap.assign((deletedBatch.size() + 63) / 64, 0);
+  assertEquals(deleted.size(), testMap.insert_batch(deletedBatch, bitmap));
+  for (auto& k : deleted)
+    assertEquals(true, testMap.find(k) != testMap.end());
+  assertEquals(deleted.size() + 1, testMap.erase_batch(deletedBatch, bitmap));
+  assertEquals(~uint64_t{0}, bitmap[0]);
+  for (auto& k : deletedBatch)
+    assertEquals(true, testMap.find(k) == testMap.end());
+  s.erase(*s.begin());
+  assertEquals(s.size(), testMap.size());
+  for (auto& key : s)
+    assertEquals(key, testMap.find(key)->key);
+
   // Check reset
   testMap.clear();
   for (const auto& e : testMap.data()) {
@@ -121,6 +178,134 @@ void testMap() {
   std::cout << "Test Passed!" << std::endl;
 }
 
+void testStats() {
+  using StatsSet = ykoh::robinhood::robinhood_set_fixed<
+      uint64_t, 0, KeyTraits<uint64_t>, ModuloCapacity, CountingStats>;
+  using PlainSet = ykoh::robinhood::robinhood_set_fixed<uint64_t, 0>;
+  // Disabled stats take no space
+  static_assert(sizeof(PlainSet) ==
+                sizeof(size_t) + sizeof(std::vector<PlainSet::EntryT>));
+
+  constexpr size_t capacity = 4096;
+  constexpr size_t numKeys = capacity * 9 / 10;
+  StatsSet testSet{capacity};
+  std::vector<uint64_t> keys;
+  while (keys.size() != numKeys) {
+    auto k = gen32();
+    if (testSet.insert(k))
+      keys.push_back(k);
+  }
+  for (auto k : keys)
+    assertEquals(true, testSet.find(k) != testSet.end());
+  for (size_t i = 0; i < 100; ++i)
+    testSet.find(uint64_t{1} << 40 | i);
+
+  auto stats = testSet.stats();
+  assertEquals(numKeys, static_cast<size_t>(stats.inserts));
+  assertEquals(numKeys, static_cast<size_t>(stats.findHits));
+  assertEquals(100ul, stats.findMisses);
+  assertEquals(true, stats.findProbes >= stats.findHits);
+  assertEquals(numKeys, stats.size);
+  assertEquals(capacity, stats.capacity);
+  size_t histogramTotal = 0, pslSum = 0;
+  for (size_t psl = 0; psl < stats.pslHistogram.size(); ++psl)
+    histogramTotal += stats.pslHistogram[psl],
+        pslSum += psl * stats.pslHistogram[psl];
+  assertEquals(numKeys, histogramTotal);
+  assertEquals(stats.pslHistogram.size() - 1, stats.maxPsl);
+  assertEquals(static_cast<double>(pslSum) / numKeys, stats.meanPsl);
+  // A hit on a key with PSL p probes p + 1 buckets
+  assertEquals(true, stats.findProbes >= pslSum + numKeys);
+
+  // Backshift chains are tracked by erase
+  testSet.reset_stats();
+  for (size_t i = 0; i < numKeys / 2; ++i)
+    assertEquals(true, testSet.erase(keys[i]));
+  stats = testSet.stats();
+  assertEquals(numKeys / 2, static_cast<size_t>(stats.erases));
+  // Erase probes are not counted as finds
+  assertEquals(0ul, stats.findHits + stats.findMisses + stats.findProbes);
+  assertEquals(true, stats.eraseProbes >= stats.erases);
+  assertEquals(true, stats.maxBackshift <= stats.backshifts);
+  assertEquals(0ul, stats.inserts);
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// Bulk construction must give the same set as inserting keys one by one
+template <template <class, size_t> class MapTemplate, class KeyT, size_t N>
+void testAssign(size_t numKeys) {
+  using MapType = MapTemplate<KeyT, N>;
+  constexpr bool isDynamic = std::is_constructible_v<MapType, size_t>;
+  MapType testMap = [&]() {
+    if constexpr (isDynamic)
+      return MapType{N};
+    else
+      return MapType{};
+  }();
+
+  // Keys with duplicates
+  std::vector<KeyT> keys;
+  std::unordered_set<KeyT> s;
+  while (s.size() != numKeys) {
+    auto k = static_cast<KeyT>(gen32());
+    keys.push_back(k);
+    s.insert(k);
+    if (gen32() % 4 == 0)
+      keys.push_back(k);
+  }
+  assertEquals(s.size(), testMap.assign(keys.begin(), keys.end()));
+  assertEquals(s.size(), testMap.size());
+
+  // Layout is a valid robinhood layout
+  auto& buckets = testMap.data();
+  for (size_t pos = 0; pos < buckets.size(); ++pos) {
+    auto& e = buckets[pos];
+    if (e.isEmpty())
+      continue;
+    auto homePos = (pos + buckets.size() - e.psl) % buckets.size();
+    assertEquals(homePos, static_cast<size_t>(testMap.hash_function()(e.key) %
+                                              buckets.size()));
+    auto& prev = buckets[(pos + buckets.size() - 1) % buckets.size()];
+    if (e.psl > 0) {
+      assertEquals(true, prev.isOccupied());
+      assertEquals(true, prev.psl + 1 >= e.psl);
+    }
+  }
+  for (auto k : s)
+    assertEquals(k, testMap.find(k)->key);
+  for (size_t i = 0; i < numKeys; ++i) {
+    auto k = static_cast<KeyT>(gen32());
+    assertEquals(s.count(k) == 1, testMap.find(k) != testMap.end());
+  }
+
+  // The set stays fully usable afterwards
+  for (auto k : s)
+    assertEquals(true, testMap.erase(k));
+  assertEquals(0ul, testMap.size());
+
+  // Too many keys
+  keys.clear();
+  while (keys.size() != N + 1)
+    keys.push_back(static_cast<KeyT>(keys.size()));
+  bool thrown = false;
+  try {
+    testMap.assign(keys.begin(), keys.end());
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  assertEquals(true, thrown);
+
+  // Bulk construction
+  if constexpr (isDynamic) {
+    MapType built(N, s.begin(), s.end());
+    for (auto k : s)
+      assertEquals(true, built.find(k) != built.end());
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
 int main() {
   testMap<VectorMap, uint32_t, 10384>();
   testMap<ArrayMap, uint32_t, 10384>();
@@ -130,5 +315,21 @@ int main() {
   testMap<ArrayMap, uint64_t, 5192>();
   testMap<VectorMap, int64_t, 5192>();
   testMap<ArrayMap, int64_t, 5192>();
+  testMap<VectorMapPow2, uint32_t, 8192>();
+  testMap<ArrayMapPow2, uint32_t, 8192>();
+  testMap<VectorMapPow2, uint64_t, 4096>();
+  testMap<ArrayMapPow2, int64_t, 4096>();
+  testMap<VectorMapFastRange, uint32_t, 10384>();
+  testMap<ArrayMapFastRange, uint32_t, 10384>();
+  testMap<VectorMapFastRange, uint64_t, 5192>();
+  testMap<ArrayMapFastRange, int64_t, 5192>();
+  // Large enough for batched lookups to interleave their probes
+  testMap<VectorMap, uint64_t, 100000>();
+  testStats();
+  testAssign<VectorMap, uint32_t, 10384>(9000);
+  testAssign<ArrayMap, uint64_t, 5192>(4000);
+  // Completely full, the last cluster wraps around onto the first one
+  testAssign<VectorMap, uint32_t, 1000>(1000);
+  testAssign<ArrayMap, int64_t, 777>(777);
   return 2;
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "../sparse-table/include/SparseTable.hpp"
+#include "../sparse-table/include/SparseTableArg.hpp"
+#include "../sparse-table/include/SparseTableOps.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace sp = ykoh::sparse_tb;
+
+static std::mt19937_64 gen64(0);
+
+// Every range of every size up to maxSize, small values give many ties
+// which must go to the leftmost position
+template <class Func, typename Index> void testAllRanges(size_t maxSize) {
+  for (size_t n = 0; n <= maxSize; ++n) {
+    auto data = std::vector<int64_t>(n);
+    for (auto &x : data)
+      x = static_cast<int64_t>(gen64() % 5);
+    auto table = sp::SparseTableArg<int64_t, Func, Index>(data);
+    ykoh::test_utils::assertEquals(n, table.size());
+
+    for (size_t start = 0; start < n; ++start) {
+      // End is exclusive
+      for (size_t end = start + 1; end <= n; ++end) {
+        size_t expected = start;
+        for (size_t j = start + 1; j < end; ++j) {
+          if (Func{}(data[expected], data[j]) != data[expected])
+            expected = j;
+        }
+        auto [arg, value] = table.computeArgForRange(start, end);
+        ykoh::test_utils::assertEquals(expected, arg);
+        ykoh::test_utils::assertEquals(data[expected], value);
+      }
+    }
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// LCA of random trees through the argmin of depths over an Euler tour
+void testEulerTourLca(size_t numNodes) {
+  auto parent = std::vector<size_t>(numNodes, 0);
+  auto depth = std::vector<uint32_t>(numNodes, 0);
+  auto children = std::vector<std::vector<size_t>>(numNodes);
+  for (size_t v = 1; v < numNodes; ++v) {
+    parent[v] = gen64() % v;
+    depth[v] = depth[parent[v]] + 1;
+    children[parent[v]].push_back(v);
+  }
+
+  // Iterative Euler tour, a node is visited again after each child
+  auto tour = std::vector<size_t>();
+  auto first = std::vector<size_t>(numNodes);
+  auto stack = std::vector<std::pair<size_t, size_t>>{{0, 0}};
+  while (!stack.empty()) {
+    auto &[v, nextChild] = stack.back();
+    if (nextChild == 0)
+      first[v] = tour.size();
+    tour.push_back(v);
+    if (nextChild < children[v].size()) {
+      auto child = children[v][nextChild++];
+      stack.push_back({child, 0});
+    } else {
+      stack.pop_back();
+    }
+  }
+  auto tourDepths = std::vector<uint32_t>(tour.size());
+  for (size_t i = 0; i < tour.size(); ++i)
+    tourDepths[i] = depth[tour[i]];
+  auto table = sp::SparseTableArg<uint32_t, sp::ops::Min>(tourDepths);
+
+  for (size_t q = 0; q < 20000; ++q) {
+    auto u = gen64() % numNodes, v = gen64() % numNodes;
+    auto [left, right] = std::minmax(first[u], first[v]);
+    auto lca = tour[table.computeArgForRange(left, right + 1).first];
+    // Naive LCA by walking up
+    while (u != v) {
+      if (depth[u] < depth[v])
+        std::swap(u, v);
+      u = parent[u];
+    }
+    ykoh::test_utils::assertEquals(u, lca);
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// Positions take half the memory of the values of a SparseTable for 64-bit
+// values, a quarter with uint16_t
+void testMemory() {
+  constexpr size_t n = 60000;
+  auto data = std::vector<uint64_t>(n);
+  for (auto &x : data)
+    x = gen64();
+  auto full = sp::SparseTable<uint64_t, sp::ops::Max>(data);
+  auto args32 = sp::SparseTableArg<uint64_t, sp::ops::Max>(data);
+  auto args16 = sp::SparseTableArg<uint64_t, sp::ops::Max, uint16_t>(data);
+  auto valueBytes = n * sizeof(uint64_t);
+  auto levelBytes = full.memoryUsage() - valueBytes;
+  ykoh::test_utils::assertEquals(valueBytes + levelBytes / 2,
+                                 args32.memoryUsage());
+  ykoh::test_utils::assertEquals(valueBytes + levelBytes / 4,
+                                 args16.memoryUsage());
+  for (size_t q = 0; q < 100000; ++q) {
+    auto a = gen64() % n, b = gen64() % n;
+    auto [left, right] = std::minmax(a, b);
+    auto expected = full.computeOverlappingForRange(left, right + 1, 0);
+    ykoh::test_utils::assertEquals(
+        expected, args32.computeArgForRange(left, right + 1).second);
+    ykoh::test_utils::assertEquals(
+        expected, args16.computeArgForRange(left, right + 1).second);
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// 2^8 positions fit in uint8_t, one more does not
+void testIndexOverflow() {
+  using Table = sp::SparseTableArg<uint32_t, sp::ops::Min, uint8_t>;
+  Table(std::vector<uint32_t>(256, 1));
+  try {
+    Table(std::vector<uint32_t>(257, 1));
+  } catch (const std::runtime_error &) {
+    std::cout << "Test Passed!" << std::endl;
+    return;
+  }
+  throw std::runtime_error("Positions past the Index must throw");
+}
+
+int main() {
+  testAllRanges<sp::ops::Min, uint32_t>(70);
+  testAllRanges<sp::ops::Max, uint16_t>(70);
+  testAllRanges<sp::ops::Min, uint8_t>(256);
+  testEulerTourLca(1);
+  testEulerTourLca(100000);
+  testMemory();
+  testIndexOverflow();
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include "../sparse-table/include/SparseTable.hpp"
+#include "../sparse-table/include/SparseTableOps.hpp"
+#include "../sparse-table/include/SparseTableStatic.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace sp = ykoh::sparse_tb;
+using RangeT = std::pair<size_t, size_t>;
+
+static std::mt19937_64 gen64(0);
+
+template <typename T> std::vector<T> randomData(size_t n) {
+  auto data = std::vector<T>(n);
+  for (auto &x : data)
+    x = static_cast<T>(gen64() % 1000000);
+  return data;
+}
+
+// Random ranges, including empty and single element ones
+std::vector<RangeT> randomRanges(size_t n, size_t numRanges) {
+  auto ranges = std::vector<RangeT>(numRanges);
+  for (auto &range : ranges) {
+    auto a = gen64() % (n + 1), b = gen64() % (n + 1);
+    range = std::minmax(a, b);
+    if (gen64() % 8 == 0)
+      range.second = range.first;
+    else if (gen64() % 8 == 0)
+      range.second = std::min(range.first + 1, n);
+  }
+  return ranges;
+}
+
+// Batched answers are the answers of the single range API
+template <typename T, class Func, class Table>
+void assertMatchesSingle(const Table &table, size_t n, size_t numRanges,
+                         T init) {
+  auto ranges = randomRanges(n, numRanges);
+  // Larger than needed, the extra values are left untouched
+  auto out = std::vector<T>(numRanges + 1, T{42});
+  table.computeOverlappingForRanges(ranges, out, init);
+  for (size_t q = 0; q < numRanges; ++q) {
+    auto [left, right] = ranges[q];
+    ykoh::test_utils::assertEquals(
+        table.computeOverlappingForRange(left, right, init), out[q]);
+  }
+  ykoh::test_utils::assertEquals(T{42}, out.back());
+
+  table.computeForRanges(ranges, out, init);
+  for (size_t q = 0; q < numRanges; ++q) {
+    auto [left, right] = ranges[q];
+    ykoh::test_utils::assertEquals(table.computeForRange(left, right, init),
+                                   out[q]);
+  }
+}
+
+template <typename T, class Func> void testDynamic(size_t n, T init) {
+  auto table = sp::SparseTable<T, Func>(randomData<T>(n));
+  // Not a multiple of the block size
+  for (size_t numRanges : {0, 1, 31, 32, 33, 10000})
+    assertMatchesSingle<T, Func>(table, n, numRanges, init);
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+template <typename T, class Func> void testStatic(T init) {
+  constexpr uint32_t dataSize = 4096;
+  // Partially filled
+  constexpr uint32_t n = 3000;
+  auto table = std::make_unique<
+      sp::SparseTableStatic<T, std::bit_width(dataSize), dataSize, Func>>();
+  table->initTable(randomData<T>(n));
+  assertMatchesSingle<T, Func>(*table, n, 10000, init);
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testEmpty() {
+  auto table = sp::SparseTable<uint32_t, sp::ops::Min>(std::vector<uint32_t>{});
+  auto ranges = std::vector<RangeT>(40, RangeT{0, 0});
+  auto out = std::vector<uint32_t>(40, 0);
+  table.computeOverlappingForRanges(ranges, out, 7u);
+  ykoh::test_utils::assertEquals(true,
+                                 std::all_of(out.begin(), out.end(),
+                                             [](auto x) { return x == 7u; }));
+  table.computeForRanges(ranges, out, 9u);
+  ykoh::test_utils::assertEquals(true,
+                                 std::all_of(out.begin(), out.end(),
+                                             [](auto x) { return x == 9u; }));
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  // 32 and 64-bit types go through gathers on AVX2, others never do
+  testDynamic<uint32_t, sp::ops::Min>(100003,
+                                      std::numeric_limits<uint32_t>::max());
+  testDynamic<int64_t, sp::ops::Sum>(100003, 0);
+  testDynamic<float, sp::ops::Max>(70001,
+                                   -std::numeric_limits<float>::infinity());
+  testDynamic<double, sp::ops::Sum>(5, 0.0);
+  testDynamic<uint16_t, sp::ops::BitOr>(1000, 0);
+  testStatic<int32_t, sp::ops::Max>(std::numeric_limits<int32_t>::min());
+  testStatic<uint64_t, sp::ops::Gcd>(0);
+  testEmpty();
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include "../sparse-table/include/SparseTable.hpp"
+#include "../sparse-table/include/SparseTableBlocked.hpp"
+#include "../sparse-table/include/SparseTableOps.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace sp = ykoh::sparse_tb;
+
+static std::mt19937_64 gen64(0);
+constexpr auto u32Max = std::numeric_limits<uint32_t>::max();
+
+// Values below maxValue, small ones give many ties. Wraps around for
+// types narrower than maxValue
+template <typename T> std::vector<T> randomData(size_t n, uint64_t maxValue) {
+  auto data = std::vector<T>(n);
+  for (auto &x : data)
+    x = static_cast<T>(gen64() % maxValue);
+  return data;
+}
+
+// Every range of every size up to maxSize, including empty data, across
+// several blocks
+template <typename T, class Func, size_t BlockSize>
+void testAllRanges(size_t maxSize, uint64_t maxValue, T init) {
+  for (size_t n = 0; n <= maxSize; ++n) {
+    auto data = randomData<T>(n, maxValue);
+    auto table = sp::SparseTableBlocked<T, Func, BlockSize>(data);
+    ykoh::test_utils::assertEquals(n, table.size());
+
+    for (size_t start = 0; start <= n; ++start) {
+      // End is exclusive
+      for (size_t end = start; end <= n; ++end) {
+        auto expected = std::accumulate(data.begin() + start,
+                                        data.begin() + end, init, Func{});
+        ykoh::test_utils::assertEquals(
+            expected, table.computeOverlappingForRange(start, end, init));
+        ykoh::test_utils::assertEquals(
+            expected, table.computeForRange(start, end, init));
+      }
+    }
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// Same answers as the full table on random ranges, with the default block
+// size of each type
+template <typename T, class Func> void testMatchesFull(size_t n, T init) {
+  auto data = randomData<T>(n, u32Max);
+  auto full = sp::SparseTable<T, Func>(data);
+  auto blocked = sp::SparseTableBlocked<T, Func>(data, 4);
+  for (size_t q = 0; q < 200000; ++q) {
+    auto a = gen64() % (n + 1), b = gen64() % (n + 1);
+    auto [left, right] = std::minmax(a, b);
+    ykoh::test_utils::assertEquals(
+        full.computeOverlappingForRange(left, right, init),
+        blocked.computeOverlappingForRange(left, right, init));
+  }
+  // Linear memory, the masks of a byte take the most
+  ykoh::test_utils::assertEquals(true, blocked.memoryUsage() <
+                                           full.memoryUsage() / 2);
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testAllRanges<uint32_t, sp::ops::Min, 8>(70, 4, u32Max);
+  testAllRanges<uint32_t, sp::ops::Min, 16>(70, u32Max, u32Max);
+  testAllRanges<int64_t, sp::ops::Max, 32>(140, 3, -1);
+  testAllRanges<uint8_t, sp::ops::Max, 64>(200, 256, 0);
+  testMatchesFull<uint8_t, sp::ops::Min>(1000003, 255);
+  testMatchesFull<int32_t, sp::ops::Max>(1000003,
+                                         std::numeric_limits<int32_t>::min());
+  testMatchesFull<double, sp::ops::Min>(300007,
+                                        std::numeric_limits<double>::max());
+  return 0;
+}
@@ -0,0 +1,119 @@
+#include "../sparse-table/include/SparseTable.hpp"
+#include "../sparse-table/include/SparseTableOps.hpp"
+#include "../sparse-table/include/SparseTableStatic.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace sp = ykoh::sparse_tb;
+
+static std::mt19937_64 gen64(0);
+
+static_assert(std::is_same_v<sp::detail::SimdOpFor<sp::ops::Min, int>::type,
+                             sp::ops::Min>);
+static_assert(
+    std::is_same_v<sp::detail::SimdOpFor<
+                       std::remove_cvref_t<decltype(std::ranges::max)>,
+                       float>::type,
+                   sp::ops::Max>);
+static_assert(std::is_same_v<sp::detail::SimdOpFor<std::plus<>, int>::type,
+                             sp::ops::Sum>);
+static_assert(
+    std::is_void_v<sp::detail::SimdOpFor<std::plus<int64_t>, int>::type>);
+static_assert(std::is_void_v<sp::detail::SimdOpFor<sp::ops::Gcd, int>::type>);
+
+template <typename T> std::vector<T> randomData(size_t n) {
+  auto data = std::vector<T>(n);
+  for (auto &x : data) {
+    if constexpr (std::is_floating_point_v<T>)
+      x = static_cast<T>(static_cast<int64_t>(gen64() % 2000001) - 1000000) /
+          T{7};
+    else
+      x = static_cast<T>(gen64() % 1000000 + 1);
+  }
+  return data;
+}
+
+// Cells of the table built with Func on numThreads threads equal the cells
+// built by the scalar lambda on one thread: computeForRange over a power of
+// two range reads exactly one cell. Checks every level, and every cell near
+// slice boundaries thanks to an odd stride
+template <typename T, class Func, class ScalarFunc>
+void testMatchesScalar(size_t n, T identity) {
+  auto data = randomData<T>(n);
+  auto expected = sp::SparseTable<T, ScalarFunc>(data);
+  for (size_t numThreads : {1, 2, 3, 8}) {
+    auto actual = sp::SparseTable<T, Func>(data, numThreads);
+    for (size_t i = 0; i < actual.numLevels(); ++i) {
+      for (size_t j = 0; j < actual.levelLength(i); j += 5) {
+        auto right = j + (size_t{1} << i);
+        ykoh::test_utils::assertEquals(
+            expected.computeForRange(j, right, identity),
+            actual.computeForRange(j, right, identity));
+      }
+    }
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// The static table goes through the same build
+void testStatic() {
+  constexpr uint32_t dataSize = 1 << 16;
+  auto data = randomData<int32_t>(dataSize);
+  using StaticTable =
+      sp::SparseTableStatic<int32_t, std::bit_width(dataSize), dataSize,
+                            sp::ops::Max>;
+  auto table = std::make_unique<StaticTable>();
+  table->initTable(data, 4);
+
+  std::mt19937 gen32(0);
+  for (size_t q = 0; q < 2000; ++q) {
+    auto a = gen32() % (dataSize + 1), b = gen32() % (dataSize + 1);
+    auto [left, right] = std::minmax(a, b);
+    auto expected = std::accumulate(data.begin() + left, data.begin() + right,
+                                    std::numeric_limits<int32_t>::min(),
+                                    sp::ops::Max{});
+    ykoh::test_utils::assertEquals(
+        expected, table->computeOverlappingForRange(
+                      left, right, std::numeric_limits<int32_t>::min()));
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  // Sizes that are not multiples of any vector width
+  constexpr size_t n = 100003;
+  auto minLambda = [](auto x, auto y) { return std::min(x, y); };
+  auto maxLambda = [](auto x, auto y) { return std::max(x, y); };
+  auto sumLambda = [](auto x, auto y) { return x + y; };
+  auto andLambda = [](auto x, auto y) { return x & y; };
+  auto orLambda = [](auto x, auto y) { return x | y; };
+  auto gcdLambda = [](auto x, auto y) { return std::gcd(x, y); };
+
+  testMatchesScalar<uint8_t, sp::ops::Min, decltype(minLambda)>(n, 255);
+  testMatchesScalar<int16_t, sp::ops::Max, decltype(maxLambda)>(n, INT16_MIN);
+  testMatchesScalar<int32_t, sp::ops::Min, decltype(minLambda)>(n, INT32_MAX);
+  testMatchesScalar<uint32_t, decltype(std::ranges::max), decltype(maxLambda)>(
+      n, 0);
+  testMatchesScalar<int64_t, sp::ops::Sum, decltype(sumLambda)>(n, 0);
+  testMatchesScalar<uint64_t, std::plus<>, decltype(sumLambda)>(n, 0);
+  testMatchesScalar<float, sp::ops::Min, decltype(minLambda)>(
+      n, std::numeric_limits<float>::infinity());
+  testMatchesScalar<double, sp::ops::Sum, decltype(sumLambda)>(n, 0.0);
+  testMatchesScalar<uint32_t, sp::ops::BitAnd, decltype(andLambda)>(n, ~0u);
+  testMatchesScalar<uint64_t, std::bit_or<>, decltype(orLambda)>(n, 0);
+  testMatchesScalar<uint32_t, sp::ops::Gcd, decltype(gcdLambda)>(n, 0);
+  testStatic();
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include "../sparse-table/include/SparseTableOps.hpp"
+#include "../sparse-table/include/SparseTableStatic.hpp"
+#include "TestUtil.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+
+namespace sp = ykoh::sparse_tb;
+
+// Tables built during compilation, checked with static_assert
+
+static_assert(sp::detail::fastLog2Floor(1) == 0);
+static_assert(sp::detail::fastLog2Floor(1000) == 9);
+
+constexpr auto kData = std::array<int32_t, 10>{5, -3, 8, 1, 9, -7, 2, 2, 6, 0};
+
+constexpr auto kMins =
+    sp::SparseTableStatic<int32_t, 4, 10, sp::ops::Min>(kData);
+static_assert(kMins.computeOverlappingForRange(0, 10, 100) == -7);
+static_assert(kMins.computeOverlappingForRange(0, 5, 100) == -3);
+static_assert(kMins.computeOverlappingForRange(6, 9, 100) == 2);
+static_assert(kMins.computeForRange(2, 4, 100) == 1);
+static_assert(kMins.computeForRange(3, 3, 100) == 100);
+
+constexpr auto kSums =
+    sp::SparseTableStatic<int64_t, 4, 10, sp::ops::Sum>(kData);
+static_assert(kSums.computeForRange(0, 10, 0) == 23);
+static_assert(kSums.computeForRange(1, 7, 0) == 10);
+static_assert(kSums.computeForRange(4, 5, 0) == 9);
+
+// Partially filled, with a lambda as Func
+constexpr auto gcdLambda = [](uint32_t x, uint32_t y) {
+  return std::gcd(x, y);
+};
+constexpr auto kGcds =
+    sp::SparseTableStatic<uint32_t, 5, 16, decltype(gcdLambda)>(
+        std::array<uint32_t, 6>{12, 18, 24, 36, 7, 14});
+static_assert(kGcds.computeOverlappingForRange(0, 4, 0) == 6);
+static_assert(kGcds.computeOverlappingForRange(4, 6, 0) == 7);
+static_assert(kGcds.computeOverlappingForRange(0, 6, 0) == 1);
+
+// Every range of the constexpr table, against the same table built at run
+// time
+template <class Table, class Func, typename T>
+void testMatchesRuntime(const Table &table, T init) {
+  auto runtimeTable = std::make_unique<Table>(kData);
+  for (size_t left = 0; left <= kData.size(); ++left) {
+    for (size_t right = left; right <= kData.size(); ++right) {
+      ykoh::test_utils::assertEquals(
+          runtimeTable->computeForRange(left, right, init),
+          table.computeForRange(left, right, init));
+      ykoh::test_utils::assertEquals(
+          std::accumulate(kData.begin() + left, kData.begin() + right, init,
+                          [](T x, T y) { return Func{}(x, y); }),
+          table.computeForRange(left, right, init));
+    }
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testMatchesRuntime<decltype(kMins), sp::ops::Min>(
+      kMins, std::numeric_limits<int32_t>::max());
+  testMatchesRuntime<decltype(kSums), sp::ops::Sum>(kSums, int64_t{0});
+  return 0;
+}
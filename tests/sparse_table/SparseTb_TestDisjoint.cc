@@ -0,0 +1,91 @@
+#include "../sparse-table/include/DisjointSparseTable.hpp"
+#include "../sparse-table/include/SparseTable.hpp"
+#include "../sparse-table/include/SparseTableOps.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace sp = ykoh::sparse_tb;
+
+static std::mt19937_64 gen64(0);
+
+constexpr auto xorLambda = [](uint32_t x, uint32_t y) { return x ^ y; };
+// Associative but not commutative
+constexpr auto concatLambda = [](const std::string &x, const std::string &y) {
+  return x + y;
+};
+
+// Every range of every size up to maxSize, including empty data, with a
+// non-commutative Func
+void testAllRangesConcat(size_t maxSize) {
+  for (size_t n = 0; n <= maxSize; ++n) {
+    auto data = std::vector<std::string>(n);
+    for (size_t i = 0; i < n; ++i)
+      data[i] = std::string(1, static_cast<char>('a' + i % 26));
+    auto table = sp::DisjointSparseTable<std::string, decltype(concatLambda)>(
+        data);
+    ykoh::test_utils::assertEquals(n, table.size());
+
+    for (size_t start = 0; start <= n; ++start) {
+      // End is exclusive
+      for (size_t end = start; end <= n; ++end) {
+        auto expected = std::accumulate(data.begin() + start,
+                                        data.begin() + end, std::string(">"),
+                                        concatLambda);
+        ykoh::test_utils::assertEquals(expected,
+                                       table.computeForRange(start, end, ">"));
+      }
+    }
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// bit_width(n - 1) levels of n values each
+void testLevels() {
+  for (size_t n : {0, 1, 2, 3, 4, 5, 1000, 1024, 1025}) {
+    auto table = sp::DisjointSparseTable<uint32_t, decltype(xorLambda)>(
+        std::vector<uint32_t>(n, 1));
+    auto levels = n <= 1 ? n : static_cast<size_t>(std::bit_width(n - 1));
+    ykoh::test_utils::assertEquals(levels, table.numLevels());
+    ykoh::test_utils::assertEquals(n * levels * sizeof(uint32_t),
+                                   table.memoryUsage());
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// Large tables built on several threads, random ranges checked against the
+// O(log(n)) queries of SparseTable
+template <typename T, class Func>
+void testMatchesSparseTable(size_t n, size_t numThreads, T init) {
+  auto data = std::vector<T>(n);
+  for (auto &x : data)
+    x = static_cast<T>(gen64());
+  auto disjoint = sp::DisjointSparseTable<T, Func>(data, numThreads);
+  auto table = sp::SparseTable<T, Func>(data);
+  for (size_t q = 0; q < 200000; ++q) {
+    auto a = gen64() % (n + 1), b = gen64() % (n + 1);
+    auto [left, right] = std::minmax(a, b);
+    ykoh::test_utils::assertEquals(table.computeForRange(left, right, init),
+                                   disjoint.computeForRange(left, right, init));
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testAllRangesConcat(70);
+  testLevels();
+  testMatchesSparseTable<uint64_t, sp::ops::Sum>(1000003, 1, 0);
+  testMatchesSparseTable<uint64_t, sp::ops::Sum>(1000003, 4, 7);
+  testMatchesSparseTable<uint32_t, decltype(xorLambda)>((1 << 20) + 1, 3, 0);
+  return 0;
+}
@@ -0,0 +1,129 @@
+#include "../sparse-table/include/SparseTable.hpp"
+#include "../sparse-table/include/SparseTableStatic.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using u32 = uint32_t;
+using u64 = uint64_t;
+
+static std::mt19937 gen32(0);
+
+constexpr auto sumLambda = [](u64 x, u64 y) { return x + y; };
+constexpr auto minLambda = [](u32 x, u32 y) { return std::min(x, y); };
+
+std::vector<u32> randomData(size_t n) {
+  auto data = std::vector<u32>(n);
+  for (auto &x : data)
+    x = gen32();
+  return data;
+}
+
+// Every range of every size up to maxSize, including empty data
+void testAllRanges(size_t maxSize) {
+  for (size_t n = 0; n <= maxSize; ++n) {
+    auto data = randomData(n);
+    auto sums = ykoh::sparse_tb::SparseTable<u64, decltype(sumLambda)>(data);
+    auto mins = ykoh::sparse_tb::SparseTable<u32, decltype(minLambda)>(data);
+    ykoh::test_utils::assertEquals(n, sums.size());
+
+    for (size_t start = 0; start <= n; ++start) {
+      // End is exclusive
+      for (size_t end = start; end <= n; ++end) {
+        auto expectedSum = std::accumulate(data.begin() + start,
+                                           data.begin() + end, u64{0});
+        ykoh::test_utils::assertEquals(expectedSum,
+                                       sums.computeForRange(start, end, 0));
+        auto expectedMin = std::accumulate(
+            data.begin() + start, data.begin() + end,
+            std::numeric_limits<u32>::max(), minLambda);
+        ykoh::test_utils::assertEquals(
+            expectedMin, mins.computeOverlappingForRange(
+                             start, end, std::numeric_limits<u32>::max()));
+      }
+    }
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// Level i holds exactly n - 2^i + 1 values
+void testCompactLevels() {
+  for (size_t n : {1, 2, 3, 1000, 1024, 1025, 100000}) {
+    auto table =
+        ykoh::sparse_tb::SparseTable<u32, decltype(minLambda)>(randomData(n));
+    auto numLevels = static_cast<size_t>(std::bit_width(n));
+    ykoh::test_utils::assertEquals(numLevels, table.numLevels());
+    size_t expectedValues = 0;
+    for (size_t i = 0; i < numLevels; ++i) {
+      ykoh::test_utils::assertEquals(n - (size_t{1} << i) + 1,
+                                     table.levelLength(i));
+      expectedValues += n - (size_t{1} << i) + 1;
+    }
+    ykoh::test_utils::assertEquals(expectedValues * sizeof(u32),
+                                   table.memoryUsage());
+  }
+  ykoh::test_utils::assertEquals(
+      size_t{0},
+      ykoh::sparse_tb::SparseTable<u32, decltype(minLambda)>().memoryUsage());
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// Same answers as the static table, on a full static table
+void testMatchesStatic() {
+  constexpr u32 dataSize = 1024;
+  auto data = randomData(dataSize);
+  auto staticTable = std::make_unique<ykoh::sparse_tb::SparseTableStatic<
+      u32, std::bit_width(dataSize), dataSize, decltype(minLambda)>>();
+  staticTable->initTable(data);
+  auto table = ykoh::sparse_tb::SparseTable<u32, decltype(minLambda)>(data);
+
+  for (u32 start = 0; start < dataSize; ++start) {
+    for (u32 end = start + 1; end <= dataSize; ++end) {
+      ykoh::test_utils::assertEquals(
+          staticTable->computeOverlappingForRange(start, end, ~0u),
+          table.computeOverlappingForRange(start, end, ~0u));
+      ykoh::test_utils::assertEquals(
+          staticTable->computeForRange(start, end, ~0u),
+          table.computeForRange(start, end, ~0u));
+    }
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// Large table, random ranges checked against a prefix sum
+void testLarge() {
+  constexpr size_t n = size_t{1} << 22;
+  auto data = randomData(n);
+  auto sums = ykoh::sparse_tb::SparseTable<u64, decltype(sumLambda)>(data);
+  auto prefix = std::vector<u64>(n + 1, 0);
+  for (size_t i = 0; i < n; ++i)
+    prefix[i + 1] = prefix[i] + data[i];
+
+  std::mt19937_64 gen64(0);
+  for (size_t q = 0; q < 100000; ++q) {
+    auto a = gen64() % (n + 1), b = gen64() % (n + 1);
+    auto [left, right] = std::minmax(a, b);
+    ykoh::test_utils::assertEquals(prefix[right] - prefix[left],
+                                   sums.computeForRange(left, right, 0));
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+int main() {
+  testAllRanges(130);
+  testCompactLevels();
+  testMatchesStatic();
+  testLarge();
+  return 0;
+}
@@ -0,0 +1,134 @@
+#include "../sparse-table/include/SparseTableOps.hpp"
+#include "../sparse-table/include/SparseTableStream.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace sp = ykoh::sparse_tb;
+
+static std::mt19937_64 gen64(0);
+
+// Associative but not commutative
+constexpr auto concatLambda = [](const std::string &x, const std::string &y) {
+  return x + y;
+};
+
+// Every range after every push, unbounded
+void testAllRangesUnbounded(size_t maxSize) {
+  auto table = sp::SparseTableStream<uint32_t, sp::ops::Min>();
+  auto concat = sp::SparseTableStream<std::string, decltype(concatLambda)>();
+  auto data = std::vector<uint32_t>();
+  auto strings = std::vector<std::string>();
+  constexpr auto u32Max = std::numeric_limits<uint32_t>::max();
+  for (size_t n = 1; n <= maxSize; ++n) {
+    data.push_back(static_cast<uint32_t>(gen64() % 1000));
+    strings.push_back(std::string(1, static_cast<char>('a' + n % 26)));
+    table.push_back(data.back());
+    concat.push_back(strings.back());
+    ykoh::test_utils::assertEquals(n, table.size());
+    ykoh::test_utils::assertEquals(size_t{0}, table.windowStart());
+
+    for (size_t start = 0; start <= n; ++start) {
+      // End is exclusive
+      for (size_t end = start; end <= n; ++end) {
+        auto expected =
+            std::accumulate(data.begin() + start, data.begin() + end, u32Max,
+                            sp::ops::Min{});
+        ykoh::test_utils::assertEquals(
+            expected, table.computeOverlappingForRange(start, end, u32Max));
+        ykoh::test_utils::assertEquals(
+            expected, table.computeForRange(start, end, u32Max));
+        ykoh::test_utils::assertEquals(
+            std::accumulate(strings.begin() + start, strings.begin() + end,
+                            std::string(">"), concatLambda),
+            concat.computeForRange(start, end, ">"));
+      }
+    }
+  }
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// Unbounded levels hold n - 2^i + 1 cells, as SparseTable
+void testUnboundedMemory() {
+  auto table = sp::SparseTableStream<uint64_t, sp::ops::Sum>();
+  ykoh::test_utils::assertEquals(size_t{0}, table.memoryUsage());
+  constexpr size_t n = 100000;
+  for (size_t j = 0; j < n; ++j)
+    table.push_back(j);
+  size_t expectedValues = 0;
+  for (size_t len = 1; len <= n; len <<= 1)
+    expectedValues += n - len + 1;
+  ykoh::test_utils::assertEquals(expectedValues * sizeof(uint64_t),
+                                 table.memoryUsage());
+  ykoh::test_utils::assertEquals(uint64_t{n * (n - 1) / 2},
+                                 table.computeForRange(0, n, 0));
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+// Sliding window max over the last W samples, checked against a brute
+// force scan, and every range still inside the window
+void testWindow(size_t window, size_t numSamples) {
+  auto table = sp::SparseTableStream<int64_t, sp::ops::Max>(window);
+  ykoh::test_utils::assertEquals(window, table.window());
+  auto memory = table.memoryUsage();
+  ykoh::test_utils::assertEquals(
+      window * std::bit_width(window) * sizeof(int64_t), memory);
+  constexpr auto i64Min = std::numeric_limits<int64_t>::min();
+
+  auto data = std::vector<int64_t>();
+  for (size_t n = 1; n <= numSamples; ++n) {
+    data.push_back(static_cast<int64_t>(gen64() % 2001) - 1000);
+    table.push_back(data.back());
+    auto start = n > window ? n - window : 0;
+    ykoh::test_utils::assertEquals(start, table.windowStart());
+    ykoh::test_utils::assertEquals(
+        *std::max_element(data.begin() + start, data.end()),
+        table.computeOverlappingForLast(n - start, i64Min));
+
+    for (size_t left = start; left <= n; ++left) {
+      for (size_t right = left; right <= n; right += 3) {
+        auto expected = std::accumulate(data.begin() + left,
+                                        data.begin() + right, i64Min,
+                                        sp::ops::Max{});
+        ykoh::test_utils::assertEquals(
+            expected, table.computeOverlappingForRange(left, right, i64Min));
+        ykoh::test_utils::assertEquals(
+            expected, table.computeForRange(left, right, i64Min));
+      }
+    }
+  }
+  // Never grows past the window
+  ykoh::test_utils::assertEquals(memory, table.memoryUsage());
+
+  std::cout << "Test Passed!" << std::endl;
+}
+
+void testZeroWindow() {
+  try {
+    sp::SparseTableStream<int64_t, sp::ops::Max>(0);
+  } catch (const std::runtime_error &) {
+    std::cout << "Test Passed!" << std::endl;
+    return;
+  }
+  throw std::runtime_error("Window of 0 must throw");
+}
+
+int main() {
+  testAllRangesUnbounded(70);
+  testUnboundedMemory();
+  testWindow(1, 20);
+  testWindow(16, 200);
+  testWindow(37, 300);
+  testZeroWindow();
+  return 0;
+}